@@ -1,13 +1,19 @@
 #pragma once
 
+#include "latency_histogram.hpp"
 #include "output_formatter.hpp"
 
+#include <emr/debra.hpp>
 #include <emr/stamp_it.hpp>
+#include <emr/hazard_pointer.hpp>
+#include <emr/lock_free_ref_count.hpp>
 
 #include <boost/program_options/variables_map.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <random>
+#include <type_traits>
 #include <emr/detail/allocation_tracker.hpp>
 
 struct thread_local_data
@@ -15,6 +21,7 @@ struct thread_local_data
   std::mt19937 randomizer;
   size_t number_of_operations = 0;
   std::chrono::duration<double, std::nano> runtime;
+  latency_histogram latencies;
 };
 
 struct benchmark
@@ -25,6 +32,27 @@ struct benchmark
   virtual const std::type_info& reclaimer_type() const = 0;
   virtual std::string get_params() { return std::string(); }
   virtual void get_data(data_record& record) {}
+  virtual bool enable_background_reclamation() { return false; }
+  virtual bool enable_incremental_reclamation(std::size_t max_nodes, std::chrono::microseconds max_time) { return false; }
+  virtual bool enable_memory_budget(std::size_t max_unreclaimed_nodes) { return false; }
+
+  bool record_latencies = false;
+
+  // Runs a single operation and records its latency (if enabled).
+  template <class Func>
+  void run_operation(thread_local_data& data, Func&& op)
+  {
+    if (!record_latencies)
+    {
+      op();
+      return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    op();
+    auto latency = std::chrono::high_resolution_clock::now() - start;
+    data.latencies.record(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+  }
 
 #ifdef TRACK_ALLOCATIONS
   virtual emr::detail::allocation_tracker& allocation_tracker() = 0;
@@ -34,9 +62,139 @@ struct benchmark
 template <typename R>
 inline void add_performance_counters(data_record& record) {}
 
+// only reclaimers that provide a background_reclamation service support background reclamation
+template <class Reclaimer>
+auto background_reclamation(int) -> typename Reclaimer::background_reclamation*
+{
+  return nullptr;
+}
+
+template <class Reclaimer>
+void background_reclamation(...) {}
+
+template <class Reclaimer>
+using background_reclamation_t = std::remove_pointer_t<decltype(background_reclamation<Reclaimer>(0))>;
+
+template <class Service>
+bool enable_background_reclamation(Service*)
+{
+  Service::enable();
+  return true;
+}
+inline bool enable_background_reclamation(void*) { return false; }
+
+template <class Service>
+void disable_background_reclamation(Service*) { Service::disable(); }
+inline void disable_background_reclamation(void*) {}
+
+template <class Service>
+void add_background_reclamation_data(data_record& record, Service*)
+{
+  if (!Service::is_enabled())
+    return;
+  auto stats = Service::get_statistics();
+  record.add("background_batches", std::to_string(stats.submitted_batches));
+  record.add("background_retries", std::to_string(stats.retried_batches));
+}
+inline void add_background_reclamation_data(data_record& record, void*) {}
+
+// only the epoch based reclaimers support incremental reclamation
+template <class Reclaimer>
+auto incremental_reclamation(int) -> typename Reclaimer::incremental_reclamation*
+{
+  return nullptr;
+}
+
+template <class Reclaimer>
+void incremental_reclamation(...) {}
+
+template <class Reclaimer>
+using incremental_reclamation_t = std::remove_pointer_t<decltype(incremental_reclamation<Reclaimer>(0))>;
+
+template <class Service>
+bool enable_incremental_reclamation(Service*, std::size_t max_nodes, std::chrono::microseconds max_time)
+{
+  Service::enable(max_nodes, max_time);
+  return true;
+}
+inline bool enable_incremental_reclamation(void*, std::size_t, std::chrono::microseconds) { return false; }
+
+template <class Service>
+void disable_incremental_reclamation(Service*) { Service::disable(); }
+inline void disable_incremental_reclamation(void*) {}
+
+// only reclaimers with retire lists support a memory budget
+template <class Reclaimer>
+auto memory_budget(int) -> typename Reclaimer::memory_budget*
+{
+  return nullptr;
+}
+
+template <class Reclaimer>
+void memory_budget(...) {}
+
+template <class Reclaimer>
+using memory_budget_t = std::remove_pointer_t<decltype(memory_budget<Reclaimer>(0))>;
+
+// the number of times the budget has been exceeded, i.e., the reclaimer switched to aggressive mode
+inline std::atomic<size_t>& aggressive_mode_switches()
+{
+  static std::atomic<size_t> switches{0};
+  return switches;
+}
+
+template <class Service>
+bool enable_memory_budget(Service*, std::size_t max_unreclaimed_nodes)
+{
+  Service::enable(max_unreclaimed_nodes, [](bool aggressive, std::size_t)
+  {
+    if (aggressive)
+      aggressive_mode_switches().fetch_add(1, std::memory_order_relaxed);
+  });
+  return true;
+}
+inline bool enable_memory_budget(void*, std::size_t) { return false; }
+
+template <class Service>
+void disable_memory_budget(Service*) { Service::disable(); }
+inline void disable_memory_budget(void*) {}
+
+template <class Service>
+void add_memory_budget_data(data_record& record, Service*)
+{
+  if (!Service::is_enabled())
+    return;
+  record.add("aggressive_mode_switches", std::to_string(aggressive_mode_switches().exchange(0)));
+  record.add("unreclaimed_nodes", std::to_string(Service::unreclaimed_nodes()));
+}
+inline void add_memory_budget_data(data_record& record, void*) {}
+
+template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+          bool SplitRefCount>
+void add_free_list_data(data_record& record,
+  emr::lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>*)
+{
+  using reclaimer =
+    emr::lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>;
+  if (FreeListWatermark > 0)
+    record.add("trimmed_nodes", std::to_string(reclaimer::number_of_trimmed_nodes()));
+}
+inline void add_free_list_data(data_record& record, void*) {}
+
 template <class Reclaimer>
 struct benchmark_with_reclaimer : benchmark
 {
+  using background_reclamation = background_reclamation_t<Reclaimer>;
+  using incremental_reclamation = incremental_reclamation_t<Reclaimer>;
+  using memory_budget = memory_budget_t<Reclaimer>;
+
+  virtual ~benchmark_with_reclaimer()
+  {
+    disable_background_reclamation(static_cast<background_reclamation*>(nullptr));
+    disable_incremental_reclamation(static_cast<incremental_reclamation*>(nullptr));
+    disable_memory_budget(static_cast<memory_budget*>(nullptr));
+  }
+
   virtual const std::type_info& reclaimer_type() const override
   {
     return typeid(Reclaimer);
@@ -45,6 +203,24 @@ struct benchmark_with_reclaimer : benchmark
   virtual void get_data(data_record& record)
   {
     add_performance_counters<Reclaimer>(record);
+    add_background_reclamation_data(record, static_cast<background_reclamation*>(nullptr));
+    add_memory_budget_data(record, static_cast<memory_budget*>(nullptr));
+    add_free_list_data(record, static_cast<Reclaimer*>(nullptr));
+  }
+
+  virtual bool enable_background_reclamation() override
+  {
+    return ::enable_background_reclamation(static_cast<background_reclamation*>(nullptr));
+  }
+
+  virtual bool enable_incremental_reclamation(std::size_t max_nodes, std::chrono::microseconds max_time) override
+  {
+    return ::enable_incremental_reclamation(static_cast<incremental_reclamation*>(nullptr), max_nodes, max_time);
+  }
+
+  virtual bool enable_memory_budget(std::size_t max_unreclaimed_nodes) override
+  {
+    return ::enable_memory_budget(static_cast<memory_budget*>(nullptr), max_unreclaimed_nodes);
   }
 
 #ifdef TRACK_ALLOCATIONS
@@ -55,13 +231,52 @@ struct benchmark_with_reclaimer : benchmark
 #endif
 };
 
-#ifdef WITH_PERF_COUNTER
 template <>
 inline void add_performance_counters<emr::stamp_it>(data_record& record)
 {
+  // with lazy region exit we trade a delayed reclamation for fewer queue operations
+  if (emr::stamp_it::max_cached_regions() > 0)
+  {
+    record.add("max_cached_regions", std::to_string(emr::stamp_it::max_cached_regions()));
+    if (!emr::stamp_it::memory_budget::is_enabled())
+      record.add("unreclaimed_nodes", std::to_string(emr::stamp_it::memory_budget::unreclaimed_nodes()));
+  }
+
+#ifdef WITH_PERF_COUNTER
   auto cnt = emr::stamp_it::get_performance_counters();
+  record.add("lazy_region_exits", std::to_string(cnt.lazy_region_exits));
   record.add("push_iterations", std::to_string(cnt.push_iterations / (double)cnt.push_calls));
   record.add("remove_next_iterations", std::to_string(cnt.remove_next_iterations / (double)cnt.remove_calls));
   record.add("remove_prev_iterations", std::to_string(cnt.remove_prev_iterations / (double)cnt.remove_calls));
-}
+
+  // per-shard contention (only if the threads are distributed over several queues)
+  if (emr::stamp_it::number_of_shards() == 1)
+    return;
+  for (unsigned i = 0; i < emr::stamp_it::number_of_shards(); ++i)
+  {
+    auto shard_cnt = emr::stamp_it::get_performance_counters(i);
+    if (shard_cnt.push_calls == 0)
+      continue;
+    auto prefix = "shard" + std::to_string(i) + "_";
+    record.add(prefix + "push_calls", std::to_string(shard_cnt.push_calls));
+    record.add(prefix + "push_iterations", std::to_string(shard_cnt.push_iterations / (double)shard_cnt.push_calls));
+    record.add(prefix + "remove_next_iterations", std::to_string(shard_cnt.remove_next_iterations / (double)shard_cnt.remove_calls));
+    record.add(prefix + "remove_prev_iterations", std::to_string(shard_cnt.remove_prev_iterations / (double)shard_cnt.remove_calls));
+  }
 #endif
+}
+
+template <>
+inline void add_performance_counters<emr::hazard_pointer<emr::adaptive_hazard_pointer_policy<>>>(data_record& record)
+{
+  using policy = emr::adaptive_hazard_pointer_policy<>;
+  auto stats = emr::hazard_pointer<policy>::get_retire_threshold_statistics();
+  record.add("avg_retire_threshold", std::to_string(stats.avg_threshold));
+  record.add("max_retire_threshold", std::to_string(stats.max_threshold));
+}
+
+template <>
+inline void add_performance_counters<emr::debra_plus<20>>(data_record& record)
+{
+  record.add("neutralizations", std::to_string(emr::debra_plus<20>::number_of_neutralizations()));
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Histogram of operation latencies in nanoseconds. The buckets are log-linear, i.e., each
+// power of two is split into 16 sub-buckets, so recording a latency is just a few bit
+// operations and the reported percentiles have a relative error of at most 1/16.
+class latency_histogram
+{
+public:
+  void record(std::uint64_t ns)
+  {
+    ++buckets[bucket_index(ns)];
+    ++count;
+  }
+
+  void merge(const latency_histogram& other)
+  {
+    for (std::size_t i = 0; i < number_of_buckets; ++i)
+      buckets[i] += other.buckets[i];
+    count += other.count;
+  }
+
+  std::size_t size() const { return count; }
+
+  // Returns the (upper bound of the) latency below which the fraction p of all recorded latencies fall.
+  std::uint64_t percentile(double p) const
+  {
+    auto rank = static_cast<std::size_t>(p * count);
+    std::size_t seen = 0;
+    for (std::size_t i = 0; i < number_of_buckets; ++i)
+    {
+      seen += buckets[i];
+      if (seen > rank)
+        return upper_bound(i);
+    }
+    return upper_bound(number_of_buckets - 1);
+  }
+
+private:
+  static constexpr unsigned sub_bucket_bits = 4;
+  static constexpr std::size_t sub_buckets = 1 << sub_bucket_bits;
+  static constexpr std::size_t number_of_buckets = sub_buckets + (64 - sub_bucket_bits) * sub_buckets;
+
+  static unsigned log2(std::uint64_t v)
+  {
+    unsigned result = 0;
+    while (v >>= 1)
+      ++result;
+    return result;
+  }
+
+  static std::size_t bucket_index(std::uint64_t ns)
+  {
+    if (ns < sub_buckets)
+      return static_cast<std::size_t>(ns);
+    auto exponent = log2(ns);
+    auto sub_bucket = (ns >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+    return sub_buckets + (exponent - sub_bucket_bits) * sub_buckets + static_cast<std::size_t>(sub_bucket);
+  }
+
+  static std::uint64_t upper_bound(std::size_t index)
+  {
+    if (index < sub_buckets)
+      return index;
+    auto exponent = (index - sub_buckets) / sub_buckets + sub_bucket_bits;
+    auto sub_bucket = (index - sub_buckets) % sub_buckets;
+    auto width = std::uint64_t(1) << (exponent - sub_bucket_bits);
+    return (std::uint64_t(1) << exponent) + (sub_bucket + 1) * width - 1;
+  }
+
+  std::array<std::size_t, number_of_buckets> buckets{};
+  std::size_t count = 0;
+};
@@ -79,12 +79,15 @@ void list_benchmark<Reclaimer>::run(thread_local_data& data)
     r >>= bits_for_operation_count;
     auto key = r % number_of_keys;
 
-    if (action <= search_operations)
-      list.search(key);
-    else if (insertOp)
-      list.insert(key);
-    else
-      list.remove(key);
+    this->run_operation(data, [&]()
+    {
+      if (action <= search_operations)
+        list.search(key);
+      else if (insertOp)
+        list.insert(key);
+      else
+        list.remove(key);
+    });
   }
 
   // Record another n operations.
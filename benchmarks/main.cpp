@@ -2,6 +2,8 @@
 #include "list_benchmark.hpp"
 #include "queue_benchmark.hpp"
 #include "hash_map_benchmark.hpp"
+#include "reclaim_benchmark.hpp"
+#include "stall_benchmark.hpp"
 #include "test_execution.hpp"
 #include "output_formatter.hpp"
 #include "console_output_formatter.hpp"
@@ -10,6 +12,7 @@
 #include <emr/dummy.hpp>
 #include <emr/lock_free_ref_count.hpp>
 #include <emr/hazard_pointer.hpp>
+#include <emr/hazard_eras.hpp>
 #include <emr/epoch_based.hpp>
 #include <emr/new_epoch_based.hpp>
 #include <emr/quiescent_state_based.hpp>
@@ -19,6 +22,7 @@
 #include <boost/program_options.hpp>
 
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
 #include <thread>
@@ -50,14 +54,25 @@ auto make_benchmark_variations()
     { "LFRC-padded-10", benchmark_builder<Benchmark, emr::lock_free_ref_count<true, 10>>() },
     { "LFRC-padded-20", benchmark_builder<Benchmark, emr::lock_free_ref_count<true, 20>>() },
     { "LFRC-padded-100", benchmark_builder<Benchmark, emr::lock_free_ref_count<true, 100>>() },
+    { "LFRC-magazines-32", benchmark_builder<Benchmark, emr::lock_free_ref_count<false, 32, 16>>() },
+    { "LFRC-padded-magazines-32", benchmark_builder<Benchmark, emr::lock_free_ref_count<true, 32, 16>>() },
+    { "LFRC-trimmed-1000", benchmark_builder<Benchmark, emr::lock_free_ref_count<false, 0, 0, 1000>>() },
+    { "LFRC-magazines-32-trimmed-1000", benchmark_builder<Benchmark, emr::lock_free_ref_count<false, 32, 16, 1000>>() },
+    { "LFRC-split", benchmark_builder<Benchmark, emr::lock_free_ref_count<false, 0, 0, 0, true>>() },
+    { "LFRC-magazines-32-split", benchmark_builder<Benchmark, emr::lock_free_ref_count<false, 32, 16, 0, true>>() },
     { "static-HPBR", benchmark_builder<Benchmark, emr::hazard_pointer<emr::static_hazard_pointer_policy<>>>() },
     { "dynamic-HPBR", benchmark_builder<Benchmark, emr::hazard_pointer<emr::dynamic_hazard_pointer_policy<>>>() },
     { "dynamic-HPBR-strict", benchmark_builder<Benchmark, emr::hazard_pointer<emr::dynamic_hazard_pointer_policy<2,1,0>>>() },
+    { "dynamic-HPBR-adaptive", benchmark_builder<Benchmark, emr::hazard_pointer<emr::adaptive_hazard_pointer_policy<>>>() },
+    { "static-HPBR-asym", benchmark_builder<Benchmark, emr::hazard_pointer<emr::asymmetric_static_hazard_pointer_policy<>>>() },
+    { "dynamic-HPBR-asym", benchmark_builder<Benchmark, emr::hazard_pointer<emr::asymmetric_dynamic_hazard_pointer_policy<>>>() },
+    { "HE", benchmark_builder<Benchmark, emr::hazard_eras<>>() },
     { "EBR",  benchmark_builder<Benchmark, emr::epoch_based<100>>() },
     { "NEBR", benchmark_builder<Benchmark, emr::new_epoch_based<100>>() },
     { "QSBR", benchmark_builder<Benchmark, emr::quiescent_state_based>() },
     { "stamp", benchmark_builder<Benchmark, emr::stamp_it>() },
-    { "DEBRA", benchmark_builder<Benchmark, emr::debra<20>>() }
+    { "DEBRA", benchmark_builder<Benchmark, emr::debra<20>>() },
+    { "DEBRA+", benchmark_builder<Benchmark, emr::debra_plus<20>>() }
   };
 }
 
@@ -127,11 +142,56 @@ void runner::parse_arguments(int argc, char* argv[])
       po::value<unsigned>(&number_of_trials)->default_value(8),
       "the number of trials to perform"
     )
+    (
+      "stall-time",
+      po::value<unsigned>()->default_value(100),
+      "how long a thread stalls in milliseconds - only for stall benchmark"
+    )
+    (
+      "stall-interval",
+      po::value<unsigned>()->default_value(100),
+      "the time between two stalls in milliseconds - only for stall benchmark"
+    )
     (
       "memory-samples",
       po::value<unsigned>(&memory_samples)->default_value(0),
       "the number of memory usage samples per trial"
     )
+    (
+      "background-reclamation",
+      po::bool_switch(),
+      "perform the reclamation work in a background thread (if supported by the reclaimer)"
+    )
+    (
+      "incremental-reclamation",
+      po::value<unsigned>()->default_value(0),
+      "the max. number of retired nodes a thread deletes per operation (0 = unbounded) - only for epoch based reclaimers"
+    )
+    (
+      "incremental-reclamation-time",
+      po::value<unsigned>()->default_value(0),
+      "the max. time in microseconds a thread spends on deleting retired nodes per operation (0 = unbounded)"
+    )
+    (
+      "memory-budget",
+      po::value<unsigned>()->default_value(0),
+      "the max. number of retired but unreclaimed nodes before the reclaimer switches to aggressive reclamation (0 = unlimited)"
+    )
+    (
+      "stamp-it-shards",
+      po::value<unsigned>()->default_value(1),
+      "the number of thread order queues the threads get distributed over - only for stamp-it"
+    )
+    (
+      "stamp-it-lazy-exit",
+      po::value<unsigned>()->default_value(0),
+      "the max. number of regions a thread may leave without removing itself from the queue (0 = disabled) - only for stamp-it"
+    )
+    (
+      "latencies",
+      po::bool_switch(),
+      "record the latencies of the individual operations and report percentiles - only for list and queue benchmark"
+    )
     (
       "csv",
       po::value<std::string>(),
@@ -193,7 +253,9 @@ std::shared_ptr<benchmark> runner::get_benchmark()
     { "list",  make_benchmark_variations<list_benchmark>() },
     { "queue", make_benchmark_variations<queue_benchmark>() },
     { "hash_map", make_benchmark_variations<hash_map_benchmark>() },
-    { "guard_ptr", make_benchmark_variations<guard_ptr_benchmark>() }
+    { "guard_ptr", make_benchmark_variations<guard_ptr_benchmark>() },
+    { "reclaim", make_benchmark_variations<reclaim_benchmark>() },
+    { "stall", make_benchmark_variations<stall_benchmark>() }
   };
 
   auto benchmark_name_it = benchmarks.find(benchmark_name);
@@ -207,6 +269,27 @@ std::shared_ptr<benchmark> runner::get_benchmark()
 
   auto benchmark = reclaimer_name_it->second();
   benchmark->setup(vm);
+  if (vm["background-reclamation"].as<bool>() && !benchmark->enable_background_reclamation())
+    throw std::runtime_error("Reclaimer does not support background reclamation - " + reclaimer_name);
+
+  auto max_nodes = vm["incremental-reclamation"].as<unsigned>();
+  auto max_time = std::chrono::microseconds(vm["incremental-reclamation-time"].as<unsigned>());
+  if (max_time.count() > 0 && max_nodes == 0)
+    max_nodes = std::numeric_limits<unsigned>::max();
+  if (max_nodes > 0 && !benchmark->enable_incremental_reclamation(max_nodes, max_time))
+    throw std::runtime_error("Reclaimer does not support incremental reclamation - " + reclaimer_name);
+
+  auto memory_budget = vm["memory-budget"].as<unsigned>();
+  if (memory_budget > 0 && !benchmark->enable_memory_budget(memory_budget))
+    throw std::runtime_error("Reclaimer does not support a memory budget - " + reclaimer_name);
+
+  auto shards = vm["stamp-it-shards"].as<unsigned>();
+  if (shards == 0 || shards > emr::stamp_it::max_shards)
+    throw std::runtime_error("Invalid number of stamp-it shards - " + std::to_string(shards));
+  emr::stamp_it::set_number_of_shards(shards);
+  emr::stamp_it::enable_lazy_region_exit(vm["stamp-it-lazy-exit"].as<unsigned>());
+
+  benchmark->record_latencies = vm["latencies"].as<bool>();
   return benchmark;
 }
 
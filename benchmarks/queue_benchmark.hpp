@@ -49,13 +49,16 @@ void queue_benchmark<Reclaimer>::run(thread_local_data& data)
     auto action = r & 1;
     auto key = (r >> 1) % number_of_keys;
 
-    if (action)
-      queue.enqueue(key);
-    else
+    this->run_operation(data, [&]()
     {
-      int value;
-      queue.try_dequeue(value);
-    }
+      if (action)
+        queue.enqueue(key);
+      else
+      {
+        int value;
+        queue.try_dequeue(value);
+      }
+    });
   }
 
   // Record another n operations.
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "benchmark.hpp"
+
+#include <emr/acquire_guard.hpp>
+
+// Measures the cost of retiring nodes, i.e., the amortized cost of the reclaimer's
+// scan/reclamation step. Running it with an increasing number of threads shows how
+// the reclamation cost scales with the number of threads (and their hazard pointers).
+template <class Reclaimer>
+struct reclaim_benchmark : benchmark_with_reclaimer<Reclaimer>
+{
+  virtual ~reclaim_benchmark();
+  virtual void setup(const boost::program_options::variables_map& vm) override;
+  virtual void run(thread_local_data& data) override;
+
+private:
+  struct node : Reclaimer::template enable_concurrent_ptr<node, 1> {};
+  using concurrent_ptr = typename Reclaimer::template concurrent_ptr<node, 1>;
+  concurrent_ptr obj;
+};
+
+template <class Reclaimer>
+reclaim_benchmark<Reclaimer>::~reclaim_benchmark()
+{
+  // the shared object is never retired, so no other thread can reference it anymore
+  delete obj.load(std::memory_order_relaxed).get();
+}
+
+template <class Reclaimer>
+void reclaim_benchmark<Reclaimer>::setup(const boost::program_options::variables_map&)
+{
+  obj.store(new node(), std::memory_order_relaxed);
+}
+
+template <class Reclaimer>
+void reclaim_benchmark<Reclaimer>::run(thread_local_data& data)
+{
+  const size_t n = 100;
+
+  typename Reclaimer::region_guard region_guard{};
+
+  // Keep the shared object protected, so every scan finds at least one protected pointer per thread.
+  auto shared = emr::acquire_guard(obj, std::memory_order_relaxed);
+
+  concurrent_ptr ptr;
+  for (size_t i = 0; i < n; i++)
+  {
+    ptr.store(new node(), std::memory_order_relaxed);
+    auto guard = emr::acquire_guard(ptr, std::memory_order_relaxed);
+    ptr.store(nullptr, std::memory_order_relaxed);
+    guard.reclaim();
+  }
+
+  // Record another n operations.
+  data.number_of_operations += n;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "benchmark.hpp"
+
+#include <emr/acquire_guard.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Retires nodes like the reclaim benchmark, but every stall-interval milliseconds one of the
+// workers deliberately stalls for stall-time milliseconds while it is inside a critical region.
+// This simulates a thread that gets descheduled in the middle of an operation. Reclaimers that
+// rely on all threads making progress cannot reclaim any nodes while the thread is stalled,
+// unless they are able to neutralize it (DEBRA+). Use --memory-samples to observe the memory usage.
+template <class Reclaimer>
+struct stall_benchmark : benchmark_with_reclaimer<Reclaimer>
+{
+  virtual void setup(const boost::program_options::variables_map& vm) override;
+  virtual void run(thread_local_data& data) override;
+  virtual std::string get_params() override;
+  virtual void get_data(data_record& record) override;
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct node : Reclaimer::template enable_concurrent_ptr<node, 1> {};
+  using concurrent_ptr = typename Reclaimer::template concurrent_ptr<node, 1>;
+  concurrent_ptr obj;
+
+  std::chrono::milliseconds stall_time;
+  std::chrono::milliseconds stall_interval;
+  std::atomic<clock::rep> next_stall;
+  std::atomic<bool> is_stalling;
+  std::atomic<size_t> number_of_stalls;
+
+  void stall();
+  void retire_nodes(thread_local_data& data);
+};
+
+// Reclaimers that support neutralization run the stalling operation as restartable operation.
+// It runs inside a critical region, so it accesses obj through a raw pointer.
+template <class Reclaimer, class Ptr, class Func>
+auto run_stalling_operation(Ptr& obj, Func&& f, int) -> decltype(Reclaimer::restartable(f))
+{
+  Reclaimer::restartable([&]() { f(obj.load(std::memory_order_relaxed).get()); });
+}
+
+// All other reclaimers protect obj by a guard_ptr.
+template <class Reclaimer, class Ptr, class Func>
+void run_stalling_operation(Ptr& obj, Func&& f, ...)
+{
+  auto guard = emr::acquire_guard(obj, std::memory_order_relaxed);
+  f(guard.get());
+}
+
+template <class Reclaimer>
+void stall_benchmark<Reclaimer>::setup(const boost::program_options::variables_map& vm)
+{
+  stall_time = std::chrono::milliseconds(vm["stall-time"].as<unsigned>());
+  stall_interval = std::chrono::milliseconds(vm["stall-interval"].as<unsigned>());
+  next_stall.store(0, std::memory_order_relaxed);
+  is_stalling.store(false, std::memory_order_relaxed);
+  number_of_stalls.store(0, std::memory_order_relaxed);
+  obj.store(new node(), std::memory_order_relaxed);
+}
+
+template <class Reclaimer>
+void stall_benchmark<Reclaimer>::run(thread_local_data& data)
+{
+  auto now = clock::now().time_since_epoch().count();
+  if (now >= next_stall.load(std::memory_order_relaxed) &&
+      !is_stalling.exchange(true, std::memory_order_relaxed))
+  {
+    stall();
+    auto next = clock::now() + stall_interval;
+    next_stall.store(next.time_since_epoch().count(), std::memory_order_relaxed);
+    is_stalling.store(false, std::memory_order_relaxed);
+  }
+  else
+    retire_nodes(data);
+}
+
+template <class Reclaimer>
+void stall_benchmark<Reclaimer>::stall()
+{
+  auto until = clock::now() + stall_time;
+  run_stalling_operation<Reclaimer>(obj, [&](node*)
+  {
+    // If we get neutralized we simply start over and continue to sleep until the
+    // end of the stall period, just like a thread that restarts its operation.
+    std::this_thread::sleep_until(until);
+  }, 0);
+  number_of_stalls.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <class Reclaimer>
+void stall_benchmark<Reclaimer>::retire_nodes(thread_local_data& data)
+{
+  const size_t n = 100;
+
+  typename Reclaimer::region_guard region_guard{};
+
+  concurrent_ptr ptr;
+  for (size_t i = 0; i < n; i++)
+  {
+    ptr.store(new node(), std::memory_order_relaxed);
+    auto guard = emr::acquire_guard(ptr, std::memory_order_relaxed);
+    ptr.store(nullptr, std::memory_order_relaxed);
+    guard.reclaim();
+  }
+
+  data.number_of_operations += n;
+}
+
+template <class Reclaimer>
+std::string stall_benchmark<Reclaimer>::get_params()
+{
+  return "stall-time: " + std::to_string(stall_time.count()) +
+         "; stall-interval: " + std::to_string(stall_interval.count());
+}
+
+template <class Reclaimer>
+void stall_benchmark<Reclaimer>::get_data(data_record& record)
+{
+  benchmark_with_reclaimer<Reclaimer>::get_data(record);
+  record.add("stalls", std::to_string(number_of_stalls.load(std::memory_order_relaxed)));
+}
@@ -100,6 +100,17 @@ void test_execution::get_data(data_record& record)
   record.add("threads", std::to_string(threads.size()));
   record.add("runtime", std::to_string(runtime));
   record.add("ns/op", std::to_string(nanoseconds_per_operation()));
+
+  latency_histogram latencies;
+  for (auto& thread : threads)
+    thread->merge_latencies(latencies);
+  if (latencies.size() > 0)
+  {
+    record.add("latency_p50", std::to_string(latencies.percentile(0.5)));
+    record.add("latency_p99", std::to_string(latencies.percentile(0.99)));
+    record.add("latency_p999", std::to_string(latencies.percentile(0.999)));
+  }
+
   for (size_t i = 0; i < memory_samples.size(); ++i)
   {
     auto& sample = memory_samples[i];
@@ -182,6 +193,12 @@ void test_execution::testing_thread::wait_until_running_state_is(bool state) con
     ;
 }
 
+void test_execution::testing_thread::merge_latencies(latency_histogram& latencies) const
+{
+  assert(is_running == false);
+  latencies.merge(data.latencies);
+}
+
 double test_execution::testing_thread::nanoseconds_per_operation() const
 {
   assert(is_running == false);
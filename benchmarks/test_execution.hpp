@@ -47,6 +47,7 @@ private:
     void wait_until_running() const;
     void wait_until_finished() const;
     double nanoseconds_per_operation() const;
+    void merge_latencies(latency_histogram& latencies) const;
   private:
     void thread_func();
     void wait_until_all_threads_are_started();
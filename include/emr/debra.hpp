@@ -5,12 +5,20 @@
 #include <emr/detail/deletable_object.hpp>
 #include <emr/detail/thread_block_list.hpp>
 #include <emr/detail/allocation_tracker.hpp>
+#include <emr/detail/background_reclaimer.hpp>
+#include <emr/detail/deferred_callback.hpp>
+#include <emr/detail/incremental_reclaimer.hpp>
+#include <emr/detail/reclamation_budget.hpp>
+#include <emr/detail/neutralization.hpp>
 
 #include <emr/acquire_guard.hpp>
 
 namespace emr {
 
-  template <std::size_t UpdateThreshold>
+  // NeutralizationThreshold defines after how many consecutive checks that found the same
+  // thread blocking the epoch advancement this thread gets neutralized (DEBRA+).
+  // A value of 0 disables neutralization.
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold = 0>
   class debra
   {
     template <class T, class MarkedPtr>
@@ -25,6 +33,58 @@ namespace emr {
     template <class T, std::size_t N = T::number_of_mark_bits>
     using concurrent_ptr = emr::detail::concurrent_ptr<T, N, guard_ptr>;
 
+    using background_reclamation = detail::background_reclaimer<debra>;
+    using incremental_reclamation = detail::incremental_reclaimer<debra>;
+    using memory_budget = detail::reclamation_budget<debra>;
+
+    // Runs f as a restartable operation inside a critical region, so f can access nodes through
+    // raw pointers (e.g., concurrent_ptr::load) instead of guard_ptrs. If neutralization is
+    // enabled, a thread that blocks the epoch advancement while running such an operation can be
+    // neutralized by the other threads. In that case the critical region is left and f is aborted
+    // via siglongjmp and restarted from the beginning. Since no destructors are run for the
+    // aborted frames, f must not create objects with non-trivial destructors - in particular no
+    // guard_ptrs (this is checked by an assertion), locks or containers - and f itself must be
+    // trivially destructible (e.g., a lambda that captures by reference). Furthermore, f must be
+    // safe to restart at any point, i.e., it must not allocate memory, and all its changes to
+    // shared data must be done by atomic operations that can safely be repeated (like in
+    // lock-free data structures). restartable must not be called while this thread holds a
+    // guard_ptr, and nested restartable operations are not supported.
+    // Without neutralization (or on platforms without POSIX signals) f is simply called inside
+    // a critical region.
+    template <class Func>
+    static void restartable(Func&& f);
+
+    // Sets the signal that is used to neutralize threads (SIGUSR1 by default). The signal is
+    // shared by all debra instances, and it must be set before the first thread uses any of
+    // them. If the application has already installed a handler for this signal, that handler
+    // is not replaced and neutralization remains disabled.
+    static void set_neutralization_signal(int signal)
+    {
+      detail::set_neutralization_signal(signal);
+    }
+
+    // The number of neutralizations that have been performed so far.
+    static std::size_t number_of_neutralizations()
+    {
+      return neutralizations.load(std::memory_order_relaxed);
+    }
+
+    // Waits until the global epoch has been advanced often enough for all nodes retired by the
+    // calling thread to become safe to reclaim, and deletes them. Abandoned nodes are adopted on the
+    // way, but while another thread is adopting some, these are left to that thread.
+    // Threads that block the epoch advancement are neutralized if neutralization is enabled.
+    // Must not be called while the calling thread holds a guard_ptr.
+    static void synchronize();
+
+    // Tries to advance the global epoch once (without waiting for other threads) and deletes the
+    // retired nodes of the calling thread that are safe to reclaim. Returns true if none are left.
+    static bool try_flush();
+
+    // Defers the call of f until all threads that are currently inside a critical region have
+    // left it (like call_rcu), e.g., to free a buffer that is only reachable through some node.
+    template <class Func>
+    static void retire(Func&& f);
+
     ALLOCATION_TRACKER;
   private:
     using epoch_t = size_t;
@@ -35,15 +95,25 @@ namespace emr {
     struct thread_control_block;
 
     static std::atomic<epoch_t> global_epoch;
+    static std::atomic<std::size_t> neutralizations;
     static detail::thread_block_list<thread_control_block> global_thread_block_list;
     static thread_data& local_thread_data();
 
     ALLOCATION_TRACKING_FUNCTIONS;
   };
 
-  template <std::size_t UpdateThreshold>
+  // DEBRA+ - a debra instance that neutralizes threads that block the epoch advancement.
+  // Note that only operations that run via restartable can be neutralized. The operations of the
+  // data structures in this library (lists, queues, hash maps) protect nodes with guard_ptrs, so
+  // they cannot run as restartable operations - a thread that stalls inside one of them still
+  // blocks the epoch advancement just like with plain debra. Only custom read operations that
+  // traverse nodes through raw pointers (see restartable) benefit from neutralization.
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold = 10>
+  using debra_plus = debra<UpdateThreshold, NeutralizationThreshold>;
+
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, std::size_t N, class Deleter>
-  class debra<UpdateThreshold>::enable_concurrent_ptr :
+  class debra<UpdateThreshold, NeutralizationThreshold>::enable_concurrent_ptr :
     private detail::deletable_object_impl<T, Deleter>,
     private detail::tracked_object<debra>
   {
@@ -63,9 +133,9 @@ namespace emr {
     friend class guard_ptr;
   };
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  class debra<UpdateThreshold>::guard_ptr : public detail::guard_ptr<T, MarkedPtr, guard_ptr<T, MarkedPtr>>
+  class debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr : public detail::guard_ptr<T, MarkedPtr, guard_ptr<T, MarkedPtr>>
   {
     using base = detail::guard_ptr<T, MarkedPtr, guard_ptr>;
     using Deleter = typename T::Deleter;
@@ -5,35 +5,37 @@
 #include "emr/detail/orphan.hpp"
 
 #include <algorithm>
+#include <thread>
+#include <type_traits>
 
 namespace emr {
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::guard_ptr(const MarkedPtr& p) noexcept :
+  debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::guard_ptr(const MarkedPtr& p) noexcept :
     base(p)
   {
     if (this->ptr)
       local_thread_data().enter_critical();
   }
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::guard_ptr(const guard_ptr& p) noexcept :
+  debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::guard_ptr(const guard_ptr& p) noexcept :
     guard_ptr(MarkedPtr(p))
   {}
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::guard_ptr(guard_ptr&& p) noexcept :
+  debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::guard_ptr(guard_ptr&& p) noexcept :
     base(p.ptr)
   {
     p.ptr.reset();
   }
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  auto debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::operator=(const guard_ptr& p) noexcept
+  auto debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::operator=(const guard_ptr& p) noexcept
     -> guard_ptr&
   {
     if (&p == this)
@@ -47,9 +49,9 @@ namespace emr {
     return *this;
   }
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  auto debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::operator=(guard_ptr&& p) noexcept
+  auto debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::operator=(guard_ptr&& p) noexcept
     -> guard_ptr&
   {
     if (&p == this)
@@ -62,9 +64,9 @@ namespace emr {
     return *this;
   }
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  void debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::acquire(concurrent_ptr<T>& p,
+  void debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::acquire(concurrent_ptr<T>& p,
     std::memory_order order) noexcept
   {
     if (p.load(std::memory_order_relaxed) == nullptr)
@@ -81,9 +83,9 @@ namespace emr {
       local_thread_data().leave_critical();
   }
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  bool debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::acquire_if_equal(
+  bool debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::acquire_if_equal(
     concurrent_ptr<T>& p,
     const MarkedPtr& expected,
     std::memory_order order) noexcept
@@ -108,63 +110,122 @@ namespace emr {
     return this->ptr == expected;
   }
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  void debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::reset() noexcept
+  void debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::reset() noexcept
   {
     if (this->ptr)
       local_thread_data().leave_critical();
     this->ptr.reset();
   }
 
-  template <std::size_t UpdateThreshold>
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
   template <class T, class MarkedPtr>
-  void debra<UpdateThreshold>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept
+  void debra<UpdateThreshold, NeutralizationThreshold>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept
   {
     this->ptr->set_deleter(std::move(d));
     local_thread_data().add_retired_node(this->ptr.get());
     reset();
   }
 
-  template <std::size_t UpdateThreshold>
-  struct debra<UpdateThreshold>::thread_control_block :
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  struct debra<UpdateThreshold, NeutralizationThreshold>::thread_control_block :
     detail::thread_block_list<thread_control_block>::entry
   {
     thread_control_block() :
       is_in_critical_region(false),
-      local_epoch(number_epochs)
+      local_epoch(number_epochs),
+      restart_state(detail::not_restartable)
     {}
 
+    // Neutralizes the thread if it is currently running a restartable operation.
+    // Returns true if the thread has been neutralized (by this or some other thread).
+    bool neutralize()
+    {
+      // The thread must not terminate while we might still send it a signal, since its handle
+      // becomes invalid (and the block might get reused by another thread), see wait_for_signal_senders.
+      signal_senders.fetch_add(1, std::memory_order_relaxed);
+      // (12) - this seq_cst-fence enforces a total order with the seq_cst-fence (13)
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      bool result;
+      int expected = detail::restartable;
+      // (9) - this acquire-CAS synchronizes-with the release-store (8)
+      if (restart_state.compare_exchange_strong(expected, detail::neutralized,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed))
+      {
+        result = detail::send_neutralization_signal(thread);
+        if (result)
+          neutralizations.fetch_add(1, std::memory_order_relaxed);
+        else
+        {
+          // we could not signal the thread, so we must not consider it as neutralized.
+          expected = detail::neutralized;
+          restart_state.compare_exchange_strong(expected, detail::restartable, std::memory_order_relaxed);
+        }
+      }
+      else
+        result = expected == detail::neutralized;
+
+      // (14) - this release-fetch_sub synchronizes-with the acquire-load (15)
+      signal_senders.fetch_sub(1, std::memory_order_release);
+      return result;
+    }
+
+    // Called by the owning thread before it terminates; its restart_state must already be not_restartable.
+    void wait_for_signal_senders()
+    {
+      // Either a concurrent neutralize observes our restart_state and does not send a signal,
+      // or we observe its increment of signal_senders and wait until it has sent the signal.
+      // (13) - this seq_cst-fence enforces a total order with the seq_cst-fence (12)
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      // (15) - this acquire-load synchronizes-with the release-fetch_sub (14)
+      while (signal_senders.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+    }
+
     std::atomic<bool> is_in_critical_region;
     std::atomic<epoch_t> local_epoch;
+    std::atomic<int> restart_state;
+    // the number of threads that are currently trying to neutralize this thread
+    std::atomic<unsigned> signal_senders{0};
+    detail::thread_handle thread;
   };
 
-  template <std::size_t UpdateThreshold>
-  struct debra<UpdateThreshold>::thread_data
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  struct debra<UpdateThreshold, NeutralizationThreshold>::thread_data
   {
     ~thread_data()
     {
       if (control_block == nullptr)
         return; // no control_block -> nothing to do
 
-      // we can avoid creating an orphan in case we have no retired nodes left.
-      if (std::any_of(retire_lists.begin(), retire_lists.end(), [](auto p) { return p != nullptr; }))
-      {
-        // global_epoch - 1 (mod number_epochs) guarantees a full cycle, making sure no
-        // other thread may still have a reference to an object in one of the retire lists.
-        auto target_epoch = (global_epoch.load(std::memory_order_relaxed) + number_epochs - 1) % number_epochs;
-        assert(target_epoch < number_epochs);
-        global_thread_block_list.abandon_retired_nodes(new detail::orphan<number_epochs>(target_epoch, retire_lists));
-      }
+      // the pending deletions are already safe to reclaim
+      pending_deletions.delete_objects();
+
+      // the remaining nodes are abandoned, so other threads can adopt and reclaim them (see adopt_orphan)
+      // orphans are not counted until they get adopted
+      for (auto& list : retire_lists)
+        budget_counter.released(list.size());
+      detail::orphan::abandon(global_thread_block_list, retire_lists);
 
       assert(control_block->is_in_critical_region.load(std::memory_order_relaxed) == false);
+      assert(control_block->restart_state.load(std::memory_order_relaxed) == detail::not_restartable);
+      if (NeutralizationThreshold > 0)
+        control_block->wait_for_signal_senders();
       global_thread_block_list.release_entry(control_block);
     }
 
     void enter_critical()
     {
+      assert(!in_restartable && "guard_ptrs must not be used inside a restartable operation");
       if (++enter_count == 1)
+      {
+        detail::non_interruptible_section section;
         do_enter_critical();
+        incremental_reclamation::process(pending_deletions);
+      }
     }
 
     void leave_critical()
@@ -176,19 +237,124 @@ namespace emr {
 
     void add_retired_node(detail::deletable_object* p)
     {
+      detail::non_interruptible_section section;
       add_retired_node(p, control_block->local_epoch.load(std::memory_order_relaxed));
     }
 
-  private:
+    // A restartable operation runs in a critical region of its own; it does not use guard_ptrs, so
+    // there is nothing but this region that has to be released when the operation gets aborted.
+    void enter_restartable_region()
+    {
+      assert(enter_count == 0 && "restartable must not be called while holding a guard_ptr");
+      enter_count = 1;
+      detail::non_interruptible_section section;
+      do_enter_critical();
+      incremental_reclamation::process(pending_deletions);
+      in_restartable = true;
+    }
+
+    void leave_restartable_region()
+    {
+      in_restartable = false;
+      enter_count = 0;
+      do_leave_critical();
+    }
+
+#if BOOST_OS_UNIX || BOOST_OS_MACOS
+    void begin_restartable(detail::recovery_point& point)
+    {
+      detail::current_recovery_point() = &point;
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      enter_restartable_region();
+      // (8) - this release-store synchronizes-with the acquire-CAS (9)
+      control_block->restart_state.store(detail::restartable, std::memory_order_release);
+    }
+
+    void end_restartable()
+    {
+      detail::current_recovery_point() = nullptr;
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      // we might have been neutralized after f has already completed - in this case
+      // a pending signal will simply be ignored by the handler.
+      control_block->restart_state.store(detail::not_restartable, std::memory_order_relaxed);
+      leave_restartable_region();
+    }
+
+    // Called by the signal handler when the thread gets neutralized. This explicitly releases
+    // the critical region, since the siglongjmp skips leave_restartable_region.
+    static void abort_restartable(void* context)
+    {
+      auto& self = *static_cast<thread_data*>(context);
+      self.in_restartable = false;
+      self.enter_count = 0;
+      self.control_block->is_in_critical_region.store(false, std::memory_order_release);
+      self.control_block->restart_state.store(detail::not_restartable, std::memory_order_relaxed);
+    }
+#endif
+
     void ensure_has_control_block()
     {
       if (control_block == nullptr)
       {
         control_block = global_thread_block_list.acquire_entry();
+        control_block->thread = detail::current_thread();
         thread_iterator = global_thread_block_list.begin();
+        if (NeutralizationThreshold > 0)
+          detail::install_neutralization_handler();
+      }
+    }
+
+    void synchronize()
+    {
+      assert(enter_count == 0 && "synchronize must not be called while holding a guard_ptr");
+      ensure_has_control_block();
+
+      // All our retired nodes and the adopted orphans have been retired no later than in start_epoch,
+      // so they are safe to reclaim once the epoch has been advanced number_epochs times.
+      auto orphans = adopt_orphans();
+      const auto start_epoch = global_epoch.load(std::memory_order_relaxed);
+      orphans.consume([this](detail::deletable_object* p) { add_retired_node(p); });
+
+      epoch_t epoch;
+      // (10) - this acquire-load synchronizes-with the release-CAS (7)
+      while ((epoch = global_epoch.load(std::memory_order_acquire)) < start_epoch + number_epochs)
+      {
+        if (all_threads_observed(epoch))
+          try_advance_global_epoch(epoch, epoch + 1);
+        else
+          std::this_thread::yield();
+      }
+      update_local_epoch(epoch);
+
+      // The destructors of the deleted nodes might retire further nodes, so we must
+      // not delete the retire lists directly.
+      detail::retire_list reclaimable_nodes;
+      for (auto& list : retire_lists)
+      {
+        budget_counter.released(list.size());
+        reclaimable_nodes.splice(list);
       }
+      reclaimable_nodes.splice(pending_deletions);
+      reclaimable_nodes.delete_objects();
     }
 
+    bool try_flush()
+    {
+      assert(enter_count == 0 && "try_flush must not be called while holding a guard_ptr");
+      ensure_has_control_block();
+
+      // (11) - this acquire-load synchronizes-with the release-CAS (7)
+      auto epoch = global_epoch.load(std::memory_order_acquire);
+      if (all_threads_observed(epoch))
+        epoch = update_global_epoch(epoch, epoch + 1);
+      if (control_block->local_epoch.load(std::memory_order_relaxed) != epoch)
+        update_local_epoch(epoch);
+      pending_deletions.delete_objects();
+      return std::all_of(retire_lists.begin(), retire_lists.end(),
+                         [](const detail::retire_list& list) { return list.empty(); });
+    }
+
+  private:
     void do_enter_critical()
     {
       ensure_has_control_block();
@@ -204,13 +370,15 @@ namespace emr {
         entries_since_update = 0;
         update_local_epoch(epoch);
       }
-      else if (entries_since_update++ == UpdateThreshold)
+      else if (entries_since_update++ >= memory_budget::threshold(UpdateThreshold))
       {
         entries_since_update = 0;
 
         if (!thread_iterator->is_in_critical_region.load(std::memory_order_relaxed) ||
-            thread_iterator->local_epoch.load(std::memory_order_relaxed) == epoch)
+            thread_iterator->local_epoch.load(std::memory_order_relaxed) == epoch ||
+            try_neutralize(*thread_iterator))
         {
+          blocked_checks = 0;
           if (++thread_iterator == global_thread_block_list.end())
           {
             epoch = update_global_epoch(epoch, epoch + 1);
@@ -225,12 +393,27 @@ namespace emr {
       // we either just updated the global_epoch or we are observing a new epoch from some other thread
       // either way - we can reclaim all the objects from the old 'incarnation' of this epoch
       auto idx = epoch % number_epochs;
-      detail::delete_objects(retire_lists[idx]);
+      budget_counter.released(retire_lists[idx].size());
+      incremental_reclamation::delete_objects(retire_lists[idx], pending_deletions);
 
       control_block->local_epoch.store(epoch, std::memory_order_relaxed);
       thread_iterator = global_thread_block_list.begin();
+      blocked_checks = 0;
     };
 
+    bool try_neutralize(thread_control_block& laggard)
+    {
+      if (NeutralizationThreshold == 0 || !detail::neutralization_handler_installed())
+        return false;
+      if (laggard.restart_state.load(std::memory_order_relaxed) == detail::neutralized)
+        return true; // already neutralized by some other thread
+      if (++blocked_checks < NeutralizationThreshold)
+        return false;
+
+      blocked_checks = 0;
+      return laggard.neutralize();
+    }
+
     void do_leave_critical()
     {
       // (5) - this release-store synchronizes-with the acquire-fence (6)
@@ -240,73 +423,160 @@ namespace emr {
     void add_retired_node(detail::deletable_object* p, size_t epoch)
     {
       auto idx = epoch % number_epochs;
-      p->next = retire_lists[idx];
-      retire_lists[idx] = p;
+      retire_lists[idx].push(p);
+      budget_counter.retired();
     }
 
-    epoch_t update_global_epoch(epoch_t curr_epoch, epoch_t new_epoch)
+    // Checks whether all threads that are inside a critical region have observed the given epoch
+    // (or have been neutralized), i.e., whether the epoch can be advanced. In contrast to the
+    // incremental checks in do_enter_critical, this checks all threads at once.
+    bool all_threads_observed(epoch_t epoch)
     {
-      // (6) - this acquire-fence synchronizes-with the release-store (5)
-      std::atomic_thread_fence(std::memory_order_acquire);
+      return std::all_of(global_thread_block_list.begin(), global_thread_block_list.end(),
+        [this, epoch](thread_control_block& block)
+        {
+          return !block.is_in_critical_region.load(std::memory_order_relaxed) ||
+                 block.local_epoch.load(std::memory_order_relaxed) == epoch ||
+                 try_neutralize(block);
+        });
+    }
 
-      // (7) - this release-CAS synchronizes-with the acquire-load (4)
-      bool success = global_epoch.compare_exchange_strong(curr_epoch, new_epoch,
-                                                          std::memory_order_release,
-                                                          std::memory_order_relaxed);
-      if (success)
+    epoch_t update_global_epoch(epoch_t curr_epoch, epoch_t new_epoch)
+    {
+      if (try_advance_global_epoch(curr_epoch, new_epoch))
       {
-        adopt_orphans();
+        adopt_orphan(new_epoch);
         return new_epoch;
       }
       else
         return curr_epoch; // some other thread was faster -> return the reloaded value
     }
 
-    void adopt_orphans()
+    bool try_advance_global_epoch(epoch_t& curr_epoch, epoch_t new_epoch)
     {
-      auto cur = global_thread_block_list.adopt_abandoned_retired_nodes();
-      for (detail::deletable_object* next = nullptr; cur != nullptr; cur = next)
-      {
-        next = cur->next;
-        cur->next = nullptr;
-        add_retired_node(cur, static_cast<detail::orphan<number_epochs>*>(cur)->target_epoch);
-      }
+      // (6) - this acquire-fence synchronizes-with the release-store (5)
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      // (7) - this release-CAS synchronizes-with the acquire-loads (4, 10, 11)
+      return global_epoch.compare_exchange_strong(curr_epoch, new_epoch,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed);
+    }
+
+    // Adopts at most one orphan per epoch update, so the nodes of terminated threads
+    // get distributed over several updates (and threads).
+    // The orphan is added to the retire list of the previous epoch which gets reclaimed
+    // when new_epoch + 2 is reached. The nodes have been retired before the orphan was
+    // abandoned, i.e., no later than in new_epoch, so this guarantees a full cycle.
+    void adopt_orphan(epoch_t new_epoch)
+    {
+      auto orphan = global_thread_block_list.try_adopt_abandoned_retired_node();
+      if (orphan != nullptr)
+        add_retired_node(orphan, (new_epoch + number_epochs - 1) % number_epochs);
+    }
+
+    // Adopts all orphans that are currently available.
+    detail::retire_list adopt_orphans()
+    {
+      detail::retire_list result;
+      while (auto orphan = global_thread_block_list.try_adopt_abandoned_retired_node())
+        result.push(orphan);
+      return result;
     }
 
     unsigned enter_count = 0;
+    bool in_restartable = false;
     unsigned entries_since_update = 0;
+    unsigned blocked_checks = 0;
     typename detail::thread_block_list<thread_control_block>::iterator thread_iterator;
     thread_control_block* control_block = nullptr;
-    std::array<detail::deletable_object*, number_epochs> retire_lists = {};
+    std::array<detail::retire_list, number_epochs> retire_lists;
+    detail::retire_list pending_deletions;
+    typename memory_budget::thread_counter budget_counter;
 
     friend class debra;
     ALLOCATION_COUNTER(debra);
   };
 
-  template <std::size_t UpdateThreshold>
-  std::atomic<typename debra<UpdateThreshold>::epoch_t> debra<UpdateThreshold>::global_epoch;
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  std::atomic<typename debra<UpdateThreshold, NeutralizationThreshold>::epoch_t> debra<UpdateThreshold, NeutralizationThreshold>::global_epoch;
+
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  std::atomic<std::size_t> debra<UpdateThreshold, NeutralizationThreshold>::neutralizations;
 
-  template <std::size_t UpdateThreshold>
-  detail::thread_block_list<typename debra<UpdateThreshold>::thread_control_block>
-    debra<UpdateThreshold>::global_thread_block_list;
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  detail::thread_block_list<typename debra<UpdateThreshold, NeutralizationThreshold>::thread_control_block>
+    debra<UpdateThreshold, NeutralizationThreshold>::global_thread_block_list;
+
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  template <class Func>
+  void debra<UpdateThreshold, NeutralizationThreshold>::restartable(Func&& f)
+  {
+    static_assert(std::is_trivially_destructible<std::decay_t<Func>>::value,
+                  "the callable of a restartable operation must be trivially destructible");
+
+    auto& data = local_thread_data();
+#if BOOST_OS_UNIX || BOOST_OS_MACOS
+    if (NeutralizationThreshold > 0)
+    {
+      data.ensure_has_control_block();
+
+      detail::recovery_point point(data.control_block->restart_state, &thread_data::abort_restartable, &data);
+      // when the thread gets neutralized, the signal handler jumps back to this point
+      // (with the signal mask restored) and the operation is restarted.
+      sigsetjmp(point.env, 1);
+      data.begin_restartable(point);
+      f();
+      data.end_restartable();
+      return;
+    }
+#endif
+    data.enter_restartable_region();
+    f();
+    data.leave_restartable_region();
+  }
+
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  void debra<UpdateThreshold, NeutralizationThreshold>::synchronize()
+  {
+    local_thread_data().synchronize();
+  }
+
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  bool debra<UpdateThreshold, NeutralizationThreshold>::try_flush()
+  {
+    return local_thread_data().try_flush();
+  }
+
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  template <class Func>
+  void debra<UpdateThreshold, NeutralizationThreshold>::retire(Func&& f)
+  {
+    // the node is allocated before we enter the critical region, since malloc must not be interrupted
+    auto node = detail::deferred_callback<detail::deletable_object>::create(std::forward<Func>(f));
+    auto& data = local_thread_data();
+    data.enter_critical();
+    data.add_retired_node(node);
+    data.leave_critical();
+  }
 
-  template <std::size_t UpdateThreshold>
-  inline typename debra<UpdateThreshold>::thread_data& debra<UpdateThreshold>::local_thread_data()
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  inline typename debra<UpdateThreshold, NeutralizationThreshold>::thread_data& debra<UpdateThreshold, NeutralizationThreshold>::local_thread_data()
   {
     static thread_local thread_data local_thread_data;
     return local_thread_data;
   }
 
 #ifdef TRACK_ALLOCATIONS
-  template <std::size_t UpdateThreshold>
-  emr::detail::allocation_tracker debra<UpdateThreshold>::allocation_tracker;
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  emr::detail::allocation_tracker debra<UpdateThreshold, NeutralizationThreshold>::allocation_tracker;
 
-  template <std::size_t UpdateThreshold>
-  inline void debra<UpdateThreshold>::count_allocation()
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  inline void debra<UpdateThreshold, NeutralizationThreshold>::count_allocation()
   { local_thread_data().allocation_counter.count_allocation(); }
 
-  template <std::size_t UpdateThreshold>
-  inline void debra<UpdateThreshold>::count_reclamation()
+  template <std::size_t UpdateThreshold, std::size_t NeutralizationThreshold>
+  inline void debra<UpdateThreshold, NeutralizationThreshold>::count_reclamation()
   { local_thread_data().allocation_counter.count_reclamation(); }
 #endif
 }
@@ -2,6 +2,8 @@
 
 #include <boost/align/aligned_alloc.hpp>
 
+#include <type_traits>
+
 namespace emr { namespace detail {
 
   template <typename Derived, std::size_t Alignment = 0>
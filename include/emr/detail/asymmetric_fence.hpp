@@ -0,0 +1,73 @@
+#pragma once
+
+#include <boost/predef.h>
+
+#include <atomic>
+
+#if BOOST_OS_LINUX
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace emr { namespace detail {
+
+  // The fence pairs used to order the publication of a protected pointer (light fence)
+  // with the scan of all published pointers (heavy fence).
+
+  // Both sides issue a full seq_cst-fence.
+  struct symmetric_fence
+  {
+    static void light() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+    static void heavy() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+  };
+
+  // The light side is only a compiler barrier, while the heavy side uses the
+  // membarrier syscall to force a memory barrier on all running threads of the process.
+  // If membarrier is not available we fall back to seq_cst-fences on both sides.
+  struct asymmetric_fence
+  {
+    static void light()
+    {
+      if (is_available())
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+      else
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    static void heavy()
+    {
+      if (is_available())
+        membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED);
+      else
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    // This is evaluated exactly once, so light and heavy always agree on the fence mode.
+    static bool is_available()
+    {
+      static const bool available = try_register();
+      return available;
+    }
+
+  private:
+#if BOOST_OS_LINUX
+    static int membarrier(int cmd)
+    {
+      return static_cast<int>(syscall(__NR_membarrier, cmd, 0));
+    }
+
+    static bool try_register()
+    {
+      int supported = membarrier(MEMBARRIER_CMD_QUERY);
+      if (supported < 0 || (supported & MEMBARRIER_CMD_PRIVATE_EXPEDITED) == 0)
+        return false;
+      return membarrier(MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED) == 0;
+    }
+#else
+    enum { MEMBARRIER_CMD_PRIVATE_EXPEDITED };
+    static int membarrier(int) { return -1; }
+    static bool try_register() { return false; }
+#endif
+  };
+}}
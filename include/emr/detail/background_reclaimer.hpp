@@ -0,0 +1,262 @@
+#pragma once
+
+#include <emr/detail/deletable_object.hpp>
+#include <emr/detail/retire_list.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace emr { namespace detail {
+
+  // A unit of work that a mutator thread hands over to the background_reclaimer.
+  struct reclamation_batch
+  {
+    virtual ~reclamation_batch() = default;
+
+    // Tries to reclaim the nodes of this batch. Returns true if all nodes have been
+    // reclaimed; otherwise the batch is retried later.
+    virtual bool try_reclaim() = 0;
+
+    reclamation_batch* next = nullptr;
+  };
+
+  // A batch of nodes that are already known to be safe to reclaim, i.e., only the
+  // delete_self() calls are moved to the background thread.
+  struct deferred_deletion_batch : reclamation_batch
+  {
+    explicit deferred_deletion_batch(deletable_object* list) : list(list) {}
+
+    bool try_reclaim() override
+    {
+      delete_objects(list);
+      return true;
+    }
+  private:
+    deletable_object* list;
+  };
+
+  struct deferred_retire_list_deletion_batch : reclamation_batch
+  {
+    explicit deferred_retire_list_deletion_batch(retire_list&& list) : list(std::move(list)) {}
+
+    bool try_reclaim() override
+    {
+      list.delete_objects();
+      return true;
+    }
+  private:
+    retire_list list;
+  };
+
+  // Optional service that performs the reclamation work of the reclaimer Tag in a
+  // dedicated background thread. While enabled, mutator threads hand over their
+  // retired nodes in O(1) instead of reclaiming them inline; each reclaimer has its
+  // own instance that can be enabled/disabled independently.
+  //
+  // disable() must not be called concurrently with threads that still retire nodes.
+  template <class Tag>
+  class background_reclaimer
+  {
+  public:
+    struct statistics
+    {
+      size_t submitted_batches = 0;
+      size_t retried_batches = 0;
+    };
+
+    static void enable();
+    static void disable();
+    static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Transfers ownership of the batch to the background thread.
+    static void submit(reclamation_batch* batch);
+
+    // Deletes the objects of the given list - in the background if the service is enabled.
+    static void delete_objects(deletable_object*& list);
+    static void delete_objects(retire_list& list);
+
+    static statistics get_statistics();
+
+  private:
+    struct worker
+    {
+      ~worker() { background_reclaimer::disable(); }
+
+      std::thread thread;
+      std::mutex mutex;
+      std::condition_variable cv;
+      bool running = false;
+    };
+
+    static void run();
+    static bool process(reclamation_batch*& batches);
+
+    static worker instance;
+    static std::atomic<bool> enabled;
+    static std::atomic<reclamation_batch*> submitted;
+    static std::atomic<size_t> number_of_submitted_batches;
+    static std::atomic<size_t> number_of_retried_batches;
+  };
+
+  template <class Tag>
+  void background_reclaimer<Tag>::enable()
+  {
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    if (instance.running)
+      return;
+
+    instance.running = true;
+    instance.thread = std::thread(&background_reclaimer::run);
+    enabled.store(true, std::memory_order_relaxed);
+  }
+
+  template <class Tag>
+  void background_reclaimer<Tag>::disable()
+  {
+    {
+      std::lock_guard<std::mutex> lock(instance.mutex);
+      if (!instance.running)
+        return;
+      enabled.store(false, std::memory_order_relaxed);
+      instance.running = false;
+    }
+    instance.cv.notify_one();
+    instance.thread.join();
+  }
+
+  template <class Tag>
+  void background_reclaimer<Tag>::submit(reclamation_batch* batch)
+  {
+    number_of_submitted_batches.fetch_add(1, std::memory_order_relaxed);
+    auto head = submitted.load(std::memory_order_relaxed);
+    do
+    {
+      batch->next = head;
+      // (1) - this release-CAS synchronizes-with the acquire-exchange (2)
+    } while (!submitted.compare_exchange_weak(head, batch,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    if (head == nullptr)
+    {
+      // acquire the mutex so the notification cannot get lost between the
+      // worker's check for new batches and its call to wait
+      { std::lock_guard<std::mutex> lock(instance.mutex); }
+      instance.cv.notify_one();
+    }
+  }
+
+  template <class Tag>
+  void background_reclaimer<Tag>::delete_objects(deletable_object*& list)
+  {
+    if (list == nullptr)
+      return;
+
+    if (is_enabled())
+    {
+      submit(new deferred_deletion_batch(list));
+      list = nullptr;
+    }
+    else
+      detail::delete_objects(list);
+  }
+
+  template <class Tag>
+  void background_reclaimer<Tag>::delete_objects(retire_list& list)
+  {
+    if (list.empty())
+      return;
+
+    if (is_enabled())
+      submit(new deferred_retire_list_deletion_batch(list.take_nodes()));
+    else
+      list.delete_objects();
+  }
+
+  template <class Tag>
+  auto background_reclaimer<Tag>::get_statistics() -> statistics
+  {
+    statistics result;
+    result.submitted_batches = number_of_submitted_batches.load(std::memory_order_relaxed);
+    result.retried_batches = number_of_retried_batches.load(std::memory_order_relaxed);
+    return result;
+  }
+
+  template <class Tag>
+  void background_reclaimer<Tag>::run()
+  {
+    // batches that could not be reclaimed completely and have to be retried
+    reclamation_batch* pending = nullptr;
+    for (;;)
+    {
+      // (2) - this acquire-exchange synchronizes-with the release-CAS (1)
+      auto batches = submitted.exchange(nullptr, std::memory_order_acquire);
+      bool made_progress = process(batches) | process(pending);
+      // nodes that are still in use are retried in the next round
+      while (batches != nullptr)
+      {
+        auto next = batches->next;
+        batches->next = pending;
+        pending = batches;
+        batches = next;
+      }
+
+      std::unique_lock<std::mutex> lock(instance.mutex);
+      if (!instance.running && pending == nullptr && submitted.load(std::memory_order_relaxed) == nullptr)
+        break;
+
+      // Without pending batches we sleep until somebody submits new work; otherwise
+      // we back off a little to give the other threads time to release their guards.
+      auto has_work = [] { return !instance.running || submitted.load(std::memory_order_relaxed) != nullptr; };
+      if (pending == nullptr)
+        instance.cv.wait(lock, has_work);
+      else if (!made_progress)
+        instance.cv.wait_for(lock, std::chrono::milliseconds(1), has_work);
+    }
+  }
+
+  // Tries to reclaim all batches in the given list and removes the completed ones.
+  // Returns true if at least one batch has been completed.
+  template <class Tag>
+  bool background_reclaimer<Tag>::process(reclamation_batch*& batches)
+  {
+    bool result = false;
+    reclamation_batch* remaining = nullptr;
+    while (batches != nullptr)
+    {
+      auto cur = batches;
+      batches = batches->next;
+      if (cur->try_reclaim())
+      {
+        delete cur;
+        result = true;
+      }
+      else
+      {
+        number_of_retried_batches.fetch_add(1, std::memory_order_relaxed);
+        cur->next = remaining;
+        remaining = cur;
+      }
+    }
+    batches = remaining;
+    return result;
+  }
+
+  template <class Tag>
+  typename background_reclaimer<Tag>::worker background_reclaimer<Tag>::instance;
+
+  template <class Tag>
+  std::atomic<bool> background_reclaimer<Tag>::enabled;
+
+  template <class Tag>
+  std::atomic<reclamation_batch*> background_reclaimer<Tag>::submitted;
+
+  template <class Tag>
+  std::atomic<size_t> background_reclaimer<Tag>::number_of_submitted_batches;
+
+  template <class Tag>
+  std::atomic<size_t> background_reclaimer<Tag>::number_of_retried_batches;
+}}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace emr { namespace detail {
+
+  // A retired callback (similar to call_rcu) that can be put into the retire lists of a reclaimer
+  // instead of a node; "deleting" it invokes the callable. Base is the reclaimer's retired node type
+  // and must provide a virtual delete_self.
+  // Callables of up to inline_size bytes are stored in the node itself, larger ones on the heap.
+  // The nodes are recycled via a small thread-local pool, so in the steady state retiring a small
+  // callable does not allocate any memory. The callable must not throw.
+  template <class Base>
+  class deferred_callback final : public Base
+  {
+  public:
+    static constexpr std::size_t inline_size = 4 * sizeof(void*);
+
+    template <class Func, class... BaseArgs>
+    static deferred_callback* create(Func&& f, BaseArgs&&... args)
+    {
+      return new (allocate()) deferred_callback(std::forward<Func>(f), std::forward<BaseArgs>(args)...);
+    }
+
+    void delete_self() override
+    {
+      invoke(&storage);
+      this->~deferred_callback();
+      release(this);
+    }
+
+  private:
+    template <class Func, class... BaseArgs>
+    explicit deferred_callback(Func&& f, BaseArgs&&... args) :
+      Base(std::forward<BaseArgs>(args)...)
+    {
+      using F = std::decay_t<Func>;
+      emplace<F>(std::forward<Func>(f), std::integral_constant<bool, fits_inline<F>()>());
+    }
+
+    // dispatched at compile time so that the inline placement new is never instantiated for
+    // callables that do not fit into the storage
+    template <class F, class Func>
+    void emplace(Func&& f, std::true_type)
+    {
+      new (&storage) F(std::forward<Func>(f));
+      invoke = &invoke_inline<F>;
+    }
+
+    template <class F, class Func>
+    void emplace(Func&& f, std::false_type)
+    {
+      new (&storage) F*(new F(std::forward<Func>(f)));
+      invoke = &invoke_heap<F>;
+    }
+
+    template <class F>
+    static constexpr bool fits_inline()
+    {
+      return sizeof(F) <= inline_size && alignof(F) <= alignof(storage_t);
+    }
+
+    template <class F>
+    static void invoke_inline(void* storage)
+    {
+      auto& f = *static_cast<F*>(storage);
+      f();
+      f.~F();
+    }
+
+    template <class F>
+    static void invoke_heap(void* storage)
+    {
+      std::unique_ptr<F> f(*static_cast<F**>(storage));
+      (*f)();
+    }
+
+    // The free nodes of a thread; this has no dynamic initialization and a trivial destructor,
+    // so it is safe to use even while the thread's thread_local objects get destroyed.
+    struct free_node { free_node* next; };
+    struct pool_state
+    {
+      free_node* head;
+      std::size_t size;
+      bool destroyed;
+    };
+
+    struct pool_cleanup
+    {
+      ~pool_cleanup()
+      {
+        auto& pool = local_pool();
+        while (pool.head != nullptr)
+        {
+          auto next = pool.head->next;
+          ::operator delete(pool.head);
+          pool.head = next;
+        }
+        pool.size = 0;
+        // nodes that are released after this point are freed immediately
+        pool.destroyed = true;
+      }
+    };
+
+    // the max. number of free nodes a thread keeps for later reuse
+    static constexpr std::size_t max_pool_size = 64;
+
+    static pool_state& local_pool()
+    {
+      static thread_local pool_state pool{};
+      return pool;
+    }
+
+    static void* allocate()
+    {
+      auto& pool = local_pool();
+      if (pool.head == nullptr)
+        return ::operator new(sizeof(deferred_callback));
+
+      auto result = pool.head;
+      pool.head = result->next;
+      --pool.size;
+      return result;
+    }
+
+    static void release(void* p)
+    {
+      auto& pool = local_pool();
+      if (pool.destroyed || pool.size == max_pool_size)
+      {
+        ::operator delete(p);
+        return;
+      }
+
+      // ensures that the pool gets drained when the thread terminates
+      static thread_local pool_cleanup cleanup;
+      (void)cleanup;
+
+      auto node = new (p) free_node;
+      node->next = pool.head;
+      pool.head = node;
+      ++pool.size;
+    }
+
+    using storage_t = std::aligned_storage_t<inline_size>;
+    void (*invoke)(void*);
+    storage_t storage;
+  };
+}}
@@ -33,6 +33,10 @@ namespace emr { namespace detail {
       self().do_swap(g);
     }
 
+    // Reserve the reclaimer specific resources of this guard (e.g., a hazard pointer) so they
+    // are not released when the guard gets reset. This is a no-op for most reclaimers.
+    void reserve() {}
+
   protected:
     guard_ptr(const MarkedPtr& p = MarkedPtr{}) noexcept : ptr(p) {}
     MarkedPtr ptr;
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <emr/detail/background_reclaimer.hpp>
+#include <emr/detail/retire_list.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+
+namespace emr { namespace detail {
+
+  // Optional mode that bounds the reclamation work a thread performs per operation.
+  // Usually a thread that observes a new epoch deletes all retire lists that have become
+  // safe to reclaim at once, which can take several milliseconds after a burst of removals.
+  // In incremental mode these nodes are moved to a per-thread list of pending deletions
+  // instead, and every operation deletes at most max_nodes of them, stopping early once
+  // max_time has elapsed (if set).
+  // The budget should be larger than the number of nodes a thread retires per operation,
+  // otherwise the pending deletions pile up faster than they are processed.
+  //
+  // If the background_reclaimer of the same reclaimer is enabled, it takes precedence.
+  template <class Tag>
+  class incremental_reclaimer
+  {
+  public:
+    static void enable(std::size_t max_nodes,
+                       std::chrono::microseconds max_time = std::chrono::microseconds::zero())
+    {
+      assert(max_nodes > 0);
+      max_time_ns.store(std::chrono::nanoseconds(max_time).count(), std::memory_order_relaxed);
+      node_budget.store(max_nodes, std::memory_order_relaxed);
+    }
+
+    static void disable() { node_budget.store(0, std::memory_order_relaxed); }
+    static bool is_enabled() { return node_budget.load(std::memory_order_relaxed) != 0; }
+
+    // Takes the nodes of list which are known to be safe to reclaim and either deletes them
+    // immediately, hands them to the background thread or appends them to pending.
+    static void delete_objects(retire_list& list, retire_list& pending)
+    {
+      if (list.empty())
+        return;
+
+      if (background_reclaimer<Tag>::is_enabled() || !is_enabled())
+        background_reclaimer<Tag>::delete_objects(list);
+      else
+        pending.splice(list);
+    }
+
+    // Deletes as many pending nodes as the budget allows (or all of them if the
+    // incremental mode has been disabled in the meantime).
+    static void process(retire_list& pending)
+    {
+      if (pending.empty())
+        return;
+      do_process(pending);
+    }
+
+  private:
+    // the number of nodes we delete between two checks of the time budget
+    static constexpr std::size_t time_check_interval = 16;
+
+    static void do_process(retire_list& pending)
+    {
+      const auto budget = node_budget.load(std::memory_order_relaxed);
+      if (budget == 0)
+      {
+        pending.delete_objects();
+        return;
+      }
+
+      auto delete_node = [](deletable_object* p) { p->delete_self(); };
+      const auto max_time = max_time_ns.load(std::memory_order_relaxed);
+      if (max_time == 0)
+      {
+        pending.consume(delete_node, budget);
+        return;
+      }
+
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(max_time);
+      for (std::size_t deleted = 0; deleted < budget && !pending.empty(); )
+      {
+        auto n = std::min(time_check_interval, budget - deleted);
+        deleted += pending.consume(delete_node, n);
+        if (std::chrono::steady_clock::now() >= deadline)
+          break;
+      }
+    }
+
+    static std::atomic<std::size_t> node_budget;
+    static std::atomic<std::chrono::nanoseconds::rep> max_time_ns;
+  };
+
+  template <class Tag>
+  constexpr std::size_t incremental_reclaimer<Tag>::time_check_interval;
+
+  template <class Tag>
+  std::atomic<std::size_t> incremental_reclaimer<Tag>::node_budget;
+
+  template <class Tag>
+  std::atomic<std::chrono::nanoseconds::rep> incremental_reclaimer<Tag>::max_time_ns;
+}}
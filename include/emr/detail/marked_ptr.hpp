@@ -5,17 +5,48 @@
 #include <cstddef>
 
 namespace emr { namespace detail {
-  
-  template <class T, std::size_t N>
+
+  // Mark bits can only be stored in the upper bits of a pointer if these are always zero, i.e., on
+  // 64-bit platforms with 48-bit virtual addresses. This does not hold with 5-level paging (57-bit
+  // addresses on x86-64) or with tagged pointers (e.g., TBI/MTE on AArch64), and it cannot be
+  // checked at compile time, so it has to be enabled explicitly by defining WITH_UPPER_MARK_BITS.
+#ifdef WITH_UPPER_MARK_BITS
+  constexpr bool upper_mark_bits_available = sizeof(uintptr_t) == 8;
+#else
+  constexpr bool upper_mark_bits_available = false;
+#endif
+
+  // the upper mark bits start above the 48 bits of a virtual address
+  constexpr std::size_t upper_mark_bits_shift = 48;
+
+  constexpr uintptr_t lowest_bits_mask(std::size_t bits)
+  {
+    return (static_cast<uintptr_t>(1) << bits) - 1;
+  }
+
+  constexpr uintptr_t upper_bits_mask(std::size_t bits)
+  {
+    return bits == 0 ? 0 : lowest_bits_mask(bits) << upper_mark_bits_shift;
+  }
+
+  // A pointer with N mark bits. By default all mark bits are stored in the low bits of the
+  // pointer, so the target has to be aligned to 2^N bytes. If LowBits < N, only the lowest
+  // LowBits of the mark are stored there and the remaining ones in bits 48 and up of the pointer
+  // (requires upper_mark_bits_available, see above).
+  template <class T, std::size_t N, std::size_t LowBits = N>
   class marked_ptr {
+    static_assert(LowBits <= N, "LowBits must not exceed the number of mark bits");
+    static_assert(N - LowBits <= 16, "at most 16 mark bits can be stored in the upper bits");
+    static_assert(N == LowBits || upper_mark_bits_available,
+                  "upper mark bits require 48-bit virtual addresses (define WITH_UPPER_MARK_BITS)");
   public:
     // Construct a marked ptr
     marked_ptr(T* p = nullptr, uintptr_t mark = 0) noexcept
     {
       assert(mark <= MarkMask && "mark exceeds the number of bits reserved");
-      assert((reinterpret_cast<uintptr_t>(p) & MarkMask) == 0 &&
+      assert((reinterpret_cast<uintptr_t>(p) & PtrMarkMask) == 0 &&
         "bits reserved for masking are occupied by the pointer");
-      ptr = reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(p) | mark);
+      ptr = reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(p) | encode(mark));
     }
     
     // Set to nullptr
@@ -23,12 +54,12 @@ namespace emr { namespace detail {
     
     // Get mark bits
     uintptr_t mark() const noexcept {
-      return reinterpret_cast<uintptr_t>(ptr) & MarkMask;
+      return decode(reinterpret_cast<uintptr_t>(ptr));
     }
     
     // Get underlying pointer (with mark bits stripped off).
     T* get() const noexcept {
-      return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(ptr) & ~MarkMask);
+      return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(ptr) & ~PtrMarkMask);
     }
     
     // True if get() != nullptr || mark() != 0
@@ -45,7 +76,27 @@ namespace emr { namespace detail {
 
     static constexpr std::size_t number_of_mark_bits = N;
   private:
-    static constexpr uintptr_t MarkMask = (1 << N) - 1;
+    static constexpr std::size_t HighBits = N - LowBits;
+    static constexpr uintptr_t MarkMask = lowest_bits_mask(N);
+    static constexpr uintptr_t LowMarkMask = lowest_bits_mask(LowBits);
+    static constexpr uintptr_t HighMarkMask = upper_bits_mask(HighBits);
+    // the bits of the pointer value that are occupied by the mark
+    static constexpr uintptr_t PtrMarkMask = LowMarkMask | HighMarkMask;
+
+    static uintptr_t encode(uintptr_t mark) noexcept
+    {
+      if (HighBits == 0)
+        return mark;
+      return (mark & LowMarkMask) | ((mark >> LowBits) << upper_mark_bits_shift);
+    }
+
+    static uintptr_t decode(uintptr_t p) noexcept
+    {
+      if (HighBits == 0)
+        return p & LowMarkMask;
+      return (p & LowMarkMask) | (((p & HighMarkMask) >> upper_mark_bits_shift) << LowBits);
+    }
+
     T* ptr;
 
 #ifdef _MSC_VER
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <boost/predef.h>
+
+#include <atomic>
+#include <cassert>
+
+#if BOOST_OS_UNIX || BOOST_OS_MACOS
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#endif
+
+namespace emr { namespace detail {
+
+  // Support for DEBRA+ style neutralization (Brown, "Reclaiming Memory for Lock-Free Data
+  // Structures: There has to be a Better Way").
+  // A thread that is stuck in a critical region can be neutralized by some other thread by
+  // sending it a signal. The signal handler aborts the thread's current restartable operation
+  // by jumping back to the recovery point from where the operation gets restarted. Since the
+  // neutralized thread executes the signal handler before it takes any further steps in its
+  // operation, the neutralizing thread can treat it as if it had already left its critical region.
+
+  // The state of a thread's operation as seen by the other threads.
+  enum restart_state : int
+  {
+    not_restartable,
+    restartable,
+    neutralized
+  };
+
+#if BOOST_OS_UNIX || BOOST_OS_MACOS
+  using thread_handle = pthread_t;
+
+  // The signal that is used to neutralize threads. It can be changed via set_neutralization_signal
+  // as long as the signal handler has not been installed yet.
+  inline std::atomic<int>& neutralization_signal()
+  {
+    static std::atomic<int> signal{SIGUSR1};
+    return signal;
+  }
+
+  // The signal for which the handler has actually been installed (0 if none).
+  inline std::atomic<int>& installed_neutralization_signal()
+  {
+    static std::atomic<int> signal{0};
+    return signal;
+  }
+
+  inline void set_neutralization_signal(int signal)
+  {
+    assert(installed_neutralization_signal().load(std::memory_order_relaxed) == 0 &&
+           "the neutralization signal must be set before the signal handler is installed");
+    neutralization_signal().store(signal, std::memory_order_relaxed);
+  }
+
+  inline bool neutralization_handler_installed()
+  {
+    return installed_neutralization_signal().load(std::memory_order_relaxed) != 0;
+  }
+
+  inline thread_handle current_thread() { return pthread_self(); }
+
+  inline bool send_neutralization_signal(thread_handle thread)
+  {
+    int signal = installed_neutralization_signal().load(std::memory_order_relaxed);
+    return signal != 0 && pthread_kill(thread, signal) == 0;
+  }
+
+  struct recovery_point
+  {
+    using abort_func = void (*)(void*);
+
+    recovery_point(std::atomic<int>& state, abort_func on_abort, void* context) :
+      state(state),
+      on_abort(on_abort),
+      context(context)
+    {}
+
+    sigjmp_buf env;
+    std::atomic<int>& state;
+    abort_func on_abort;
+    void* context;
+    // these are accessed by the signal handler, therefore they have to be volatile
+    volatile sig_atomic_t non_interruptible = 0;
+    volatile sig_atomic_t pending = 0;
+  };
+
+  // The recovery point of the restartable operation the current thread is running (if any).
+  // This is a plain pointer without dynamic initialization, so it is safe to access it from
+  // inside the signal handler.
+  inline recovery_point*& current_recovery_point()
+  {
+    static thread_local recovery_point* point = nullptr;
+    return point;
+  }
+
+  [[noreturn]] inline void abort_operation(recovery_point& point)
+  {
+    point.pending = 0;
+    point.on_abort(point.context);
+    siglongjmp(point.env, 1);
+  }
+
+  inline void neutralization_handler(int)
+  {
+    auto point = current_recovery_point();
+    // ignore signals that arrive after the operation has already been completed
+    if (point == nullptr || point->state.load(std::memory_order_relaxed) != neutralized)
+      return;
+
+    if (point->non_interruptible)
+      point->pending = 1;
+    else
+      abort_operation(*point);
+  }
+
+  // Installs the signal handler for the configured neutralization signal (only once per process).
+  // The handler of an application that already uses this signal is never replaced - in that case
+  // neutralization stays disabled, and a different signal has to be configured via
+  // set_neutralization_signal. Returns the signal the handler is installed for, or 0 if none.
+  inline int install_neutralization_handler()
+  {
+    static const int installed = []()
+    {
+      const int signal = neutralization_signal().load(std::memory_order_relaxed);
+      struct sigaction previous{};
+      if (sigaction(signal, nullptr, &previous) != 0)
+        return 0;
+      if ((previous.sa_flags & SA_SIGINFO) != 0 || previous.sa_handler != SIG_DFL)
+      {
+        assert(false && "the neutralization signal is already in use - choose a different one");
+        return 0;
+      }
+
+      struct sigaction action{};
+      action.sa_handler = &neutralization_handler;
+      sigemptyset(&action.sa_mask);
+      // system calls interrupted by a stale signal are simply resumed
+      action.sa_flags = SA_RESTART;
+      if (sigaction(signal, &action, nullptr) != 0)
+        return 0;
+      installed_neutralization_signal().store(signal, std::memory_order_relaxed);
+      return signal;
+    }();
+    return installed;
+  }
+
+  // Defers the neutralization of the current thread until the end of the scope.
+  // Operations that modify thread local state (e.g., the retire lists) or that call
+  // non-async-signal-safe functions like malloc must not be aborted half-way.
+  class non_interruptible_section
+  {
+  public:
+    non_interruptible_section() :
+      point(current_recovery_point())
+    {
+      if (point)
+        ++point->non_interruptible;
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    ~non_interruptible_section()
+    {
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      if (point && --point->non_interruptible == 0 && point->pending)
+        abort_operation(*point);
+    }
+
+    non_interruptible_section(const non_interruptible_section&) = delete;
+    non_interruptible_section& operator=(const non_interruptible_section&) = delete;
+  private:
+    recovery_point* point;
+  };
+#else
+  // Neutralization requires POSIX signals - on all other platforms threads can never be neutralized.
+  using thread_handle = int;
+
+  inline thread_handle current_thread() { return 0; }
+  inline bool send_neutralization_signal(thread_handle) { return false; }
+  inline void set_neutralization_signal(int) {}
+  inline bool neutralization_handler_installed() { return false; }
+  inline int install_neutralization_handler() { return 0; }
+
+  class non_interruptible_section {};
+#endif
+}}
@@ -1,28 +1,49 @@
 #pragma once
 
 #include "deletable_object.hpp"
+#include "retire_list.hpp"
 #include <array>
 
 namespace emr { namespace detail
 {
 
-template <unsigned Epochs>
-struct orphan : detail::deletable_object_impl<orphan<Epochs>>
+// A chunk of retired nodes that have been abandoned by a terminating thread. The nodes of
+// a thread are split into several orphans of bounded size, so the threads that adopt them
+// only have to reclaim a bounded number of nodes at a time.
+struct orphan : detail::deletable_object_impl<orphan>
 {
-  orphan(unsigned target_epoch, std::array<detail::deletable_object*, Epochs> &retire_lists):
-    target_epoch(target_epoch),
-    retire_lists(retire_lists)
+  // The max. number of nodes in a single orphan.
+  static constexpr std::size_t max_size = 100;
+
+  explicit orphan(detail::retire_list&& nodes):
+    nodes(std::move(nodes))
   {}
 
   ~orphan()
   {
-    for (auto p: retire_lists)
-      detail::delete_objects(p);
+    nodes.delete_objects();
+  }
+
+  // Abandons all nodes in retire_lists as orphans.
+  template <class ThreadBlockList, std::size_t N>
+  static void abandon(ThreadBlockList& block_list, std::array<detail::retire_list, N>& retire_lists)
+  {
+    detail::retire_list chunk;
+    for (auto& list : retire_lists)
+    {
+      list.consume([&](detail::deletable_object* p)
+      {
+        chunk.push(p);
+        if (chunk.size() == max_size)
+          block_list.abandon_retired_nodes(new orphan(chunk.take_nodes()));
+      });
+    }
+    if (!chunk.empty())
+      block_list.abandon_retired_nodes(new orphan(chunk.take_nodes()));
   }
 
-  const unsigned target_epoch;
 private:
-  std::array<detail::deletable_object*, Epochs> retire_lists;
+  detail::retire_list nodes;
 };
 
 }}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+namespace emr { namespace detail {
+
+  // A simple open-addressing hash set for pointers (linear probing, nullptr marks an empty slot).
+  // It is intended to be reused over and over again by the same thread, so the storage is only
+  // (re)allocated when the number of elements outgrows the current capacity.
+  template <class T>
+  class pointer_set
+  {
+  public:
+    // Removes all elements and ensures that at least expected_size elements
+    // can be inserted without reallocating the storage.
+    void clear(std::size_t expected_size)
+    {
+      auto required = required_capacity(expected_size);
+      if (required > capacity)
+        allocate(required);
+      else
+        std::fill(slots.get(), slots.get() + capacity, nullptr);
+      size = 0;
+    }
+
+    void insert(const T* p)
+    {
+      if (p == nullptr)
+        return;
+
+      if (required_capacity(size + 1) > capacity)
+        grow();
+
+      if (insert_into(slots.get(), capacity, p))
+        ++size;
+    }
+
+    bool contains(const T* p) const
+    {
+      if (capacity == 0 || p == nullptr)
+        return false;
+
+      const std::size_t mask = capacity - 1;
+      for (auto idx = hash(p, capacity); ; idx = (idx + 1) & mask)
+      {
+        auto v = slots[idx];
+        if (v == p)
+          return true;
+        if (v == nullptr)
+          return false;
+      }
+    }
+
+    std::size_t get_size() const { return size; }
+    std::size_t get_capacity() const { return capacity; }
+
+  private:
+    static constexpr std::size_t min_capacity = 16;
+
+    // keep the load factor at or below 1/2 so probe sequences stay short
+    static std::size_t required_capacity(std::size_t n)
+    {
+      std::size_t result = min_capacity;
+      while (result < 2 * n)
+        result *= 2;
+      return result;
+    }
+
+    static std::size_t hash(const T* p, std::size_t capacity)
+    {
+      // Fibonacci hashing - the multiplication distributes the (aligned) pointer
+      // bits over the high bits of the result, from which we take the index.
+      auto h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(p)) * 0x9E3779B97F4A7C15ull;
+      return static_cast<std::size_t>(h >> 32) & (capacity - 1);
+    }
+
+    static bool insert_into(const T** storage, std::size_t capacity, const T* p)
+    {
+      const std::size_t mask = capacity - 1;
+      for (auto idx = hash(p, capacity); ; idx = (idx + 1) & mask)
+      {
+        auto& v = storage[idx];
+        if (v == p)
+          return false;
+        if (v == nullptr)
+        {
+          v = p;
+          return true;
+        }
+      }
+    }
+
+    void allocate(std::size_t new_capacity)
+    {
+      assert((new_capacity & (new_capacity - 1)) == 0 && "capacity must be a power of two");
+      slots.reset(new const T*[new_capacity]());
+      capacity = new_capacity;
+    }
+
+    void grow()
+    {
+      auto old_slots = std::move(slots);
+      auto old_capacity = capacity;
+      allocate(required_capacity(size + 1));
+      for (std::size_t i = 0; i < old_capacity; ++i)
+        if (old_slots[i] != nullptr)
+          insert_into(slots.get(), capacity, old_slots[i]);
+    }
+
+    std::unique_ptr<const T*[]> slots;
+    std::size_t capacity = 0;
+    std::size_t size = 0;
+  };
+}}
@@ -4,9 +4,12 @@
 #include <boost/predef.h>
 
 #if defined(BOOST_COMP_MSVC_DETECTION)
+  #include <xmmintrin.h>
   #define SELECT_ANY __declspec(selectany)
+  #define PREFETCH(p) _mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0)
 #elif defined(BOOST_COMP_GNUC_DETECTION)
   #define SELECT_ANY __attribute__((weak))
+  #define PREFETCH(p) __builtin_prefetch(p)
 #else
   #error "Unsupported compiler"
 #endif
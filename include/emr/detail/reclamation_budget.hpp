@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+namespace emr { namespace detail {
+
+  // Optional budget for the number of nodes of the reclaimer Tag that have been retired, but not
+  // yet found to be safe to reclaim. While the budget is exceeded, the reclaimer runs in aggressive
+  // mode, i.e., its threads try to reclaim at every opportunity (scans, epoch updates) instead of
+  // only after a fixed number of operations/retired nodes. The aggressive mode ends once the number
+  // of unreclaimed nodes has dropped below 3/4 of the budget. The application can register a
+  // callback that gets notified whenever the mode changes, e.g., to throttle its own allocations.
+  //
+  // Threads publish their changes in batches, so the global count is only approximate. Depending on
+  // the reclaimer, the nodes of terminated threads might not be counted until they get adopted.
+  template <class Tag>
+  class reclamation_budget
+  {
+  public:
+    // Called with aggressive = true when the budget gets exceeded and with false once the
+    // number of unreclaimed nodes has dropped again.
+    using pressure_callback = void (*)(bool aggressive, std::size_t unreclaimed_nodes);
+
+    static void enable(std::size_t max_unreclaimed_nodes, pressure_callback callback = nullptr)
+    {
+      assert(max_unreclaimed_nodes > 0);
+      on_pressure_change.store(callback, std::memory_order_relaxed);
+      budget.store(max_unreclaimed_nodes, std::memory_order_relaxed);
+      check_pressure(counter.load(std::memory_order_relaxed));
+    }
+
+    static void disable()
+    {
+      budget.store(0, std::memory_order_relaxed);
+      aggressive.store(false, std::memory_order_relaxed);
+    }
+
+    static bool is_enabled() { return budget.load(std::memory_order_relaxed) != 0; }
+    static bool is_aggressive() { return aggressive.load(std::memory_order_relaxed); }
+
+    // The approximate number of retired nodes that have not yet been found to be safe to reclaim
+    // (this is also maintained while the budget is disabled).
+    static std::size_t unreclaimed_nodes()
+    {
+      auto n = counter.load(std::memory_order_relaxed);
+      return n > 0 ? static_cast<std::size_t>(n) : 0;
+    }
+
+    // Returns the given threshold or 0 (i.e., "reclaim now") in aggressive mode.
+    static std::size_t threshold(std::size_t threshold) { return is_aggressive() ? 0 : threshold; }
+
+    // Updates the global count directly; intended for batches of nodes that are not owned by any
+    // thread, e.g., the ones processed by the background thread.
+    static void add(std::ptrdiff_t delta)
+    {
+      auto n = counter.fetch_add(delta, std::memory_order_relaxed) + delta;
+      if (is_enabled())
+        check_pressure(n);
+    }
+
+    // Accumulates the changes of a single thread.
+    class thread_counter
+    {
+    public:
+      thread_counter() = default;
+      thread_counter(const thread_counter&) = delete;
+      thread_counter& operator=(const thread_counter&) = delete;
+      ~thread_counter() { flush(); }
+
+      void retired(std::size_t n = 1) { update(static_cast<std::ptrdiff_t>(n)); }
+      void released(std::size_t n = 1) { update(-static_cast<std::ptrdiff_t>(n)); }
+
+      void flush()
+      {
+        if (delta != 0)
+        {
+          add(delta);
+          delta = 0;
+        }
+      }
+
+    private:
+      void update(std::ptrdiff_t n)
+      {
+        delta += n;
+        const auto batch = batch_size();
+        if (delta >= batch || delta <= -batch)
+          flush();
+      }
+
+      std::ptrdiff_t delta = 0;
+    };
+
+  private:
+    // the max. number of changes a thread accumulates before it updates the global counter
+    static constexpr std::ptrdiff_t max_batch_size = 32;
+
+    // small budgets need more accurate counts
+    static std::ptrdiff_t batch_size()
+    {
+      const auto max = budget.load(std::memory_order_relaxed);
+      if (max == 0)
+        return max_batch_size;
+      return std::min(max_batch_size, static_cast<std::ptrdiff_t>(max / 16 + 1));
+    }
+
+    static void check_pressure(std::ptrdiff_t n)
+    {
+      const auto max = static_cast<std::ptrdiff_t>(budget.load(std::memory_order_relaxed));
+      bool was_aggressive = aggressive.load(std::memory_order_relaxed);
+      const bool should_be_aggressive = was_aggressive ? n >= max - max / 4 : n > max;
+      if (should_be_aggressive == was_aggressive)
+        return;
+
+      // only the thread that actually changes the mode notifies the application
+      if (aggressive.compare_exchange_strong(was_aggressive, should_be_aggressive, std::memory_order_relaxed))
+      {
+        if (auto callback = on_pressure_change.load(std::memory_order_relaxed))
+          callback(should_be_aggressive, n > 0 ? static_cast<std::size_t>(n) : 0);
+      }
+    }
+
+    static std::atomic<std::size_t> budget;
+    static std::atomic<std::ptrdiff_t> counter;
+    static std::atomic<bool> aggressive;
+    static std::atomic<pressure_callback> on_pressure_change;
+  };
+
+  template <class Tag>
+  constexpr std::ptrdiff_t reclamation_budget<Tag>::max_batch_size;
+
+  template <class Tag>
+  std::atomic<std::size_t> reclamation_budget<Tag>::budget;
+
+  template <class Tag>
+  std::atomic<std::ptrdiff_t> reclamation_budget<Tag>::counter;
+
+  template <class Tag>
+  std::atomic<bool> reclamation_budget<Tag>::aggressive;
+
+  template <class Tag>
+  std::atomic<typename reclamation_budget<Tag>::pressure_callback> reclamation_budget<Tag>::on_pressure_change;
+}}
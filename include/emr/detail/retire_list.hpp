@@ -0,0 +1,211 @@
+#pragma once
+
+#include <emr/detail/aligned_object.hpp>
+#include <emr/detail/deletable_object.hpp>
+#include <emr/detail/port.hpp>
+
+#include <cstddef>
+#include <utility>
+
+namespace emr { namespace detail {
+
+  // A list of retired nodes that stores the node pointers in arrays ("bags") instead of
+  // linking the nodes themselves. Processing the list is a linear sweep over the bags
+  // that prefetches the nodes ahead, instead of chasing the next pointers from one cold
+  // node to the next. Bags that become empty are kept for reuse, so in the steady state
+  // no memory has to be allocated.
+  class retire_list
+  {
+  public:
+    retire_list() = default;
+    retire_list(retire_list&& other) noexcept :
+      head(other.head),
+      free_bags(other.free_bags),
+      number_of_free_bags(other.number_of_free_bags),
+      count(other.count)
+    {
+      other.head = nullptr;
+      other.free_bags = nullptr;
+      other.number_of_free_bags = 0;
+      other.count = 0;
+    }
+
+    retire_list& operator=(retire_list&& other) noexcept
+    {
+      if (&other != this)
+      {
+        std::swap(head, other.head);
+        std::swap(free_bags, other.free_bags);
+        std::swap(number_of_free_bags, other.number_of_free_bags);
+        std::swap(count, other.count);
+      }
+      return *this;
+    }
+
+    retire_list(const retire_list&) = delete;
+    retire_list& operator=(const retire_list&) = delete;
+
+    ~retire_list()
+    {
+      free(head);
+      free(free_bags);
+    }
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void push(deletable_object* p)
+    {
+      if (head == nullptr || head->size == bag::capacity)
+      {
+        auto b = allocate_bag();
+        b->next = head;
+        head = b;
+      }
+      head->nodes[head->size++] = p;
+      ++count;
+    }
+
+    // Calls f for all nodes and removes them from the list. The nodes are detached before
+    // f gets called, so f can safely push new nodes to this list (e.g., when the destructor
+    // of a deleted node retires further nodes).
+    template <class Func>
+    void consume(Func&& f)
+    {
+      auto bags = head;
+      head = nullptr;
+      count = 0;
+      while (bags != nullptr)
+      {
+        for (std::size_t i = 0; i < bags->size; ++i)
+        {
+          if (i + prefetch_distance < bags->size)
+            PREFETCH(bags->nodes[i + prefetch_distance]);
+          f(bags->nodes[i]);
+        }
+
+        auto next = bags->next;
+        release_bag(bags);
+        bags = next;
+      }
+    }
+
+    // Calls f for at most max_nodes nodes and removes them from the list.
+    // Returns the number of consumed nodes.
+    template <class Func>
+    std::size_t consume(Func&& f, std::size_t max_nodes)
+    {
+      std::size_t n = 0;
+      while (n < max_nodes && head != nullptr)
+      {
+        auto b = head;
+        if (b->size == 0)
+        {
+          head = b->next;
+          release_bag(b);
+          continue;
+        }
+
+        auto p = b->nodes[--b->size];
+        --count;
+        if (b->size > prefetch_distance)
+          PREFETCH(b->nodes[b->size - prefetch_distance - 1]);
+        // f may push new nodes to this list - they end up in this bag or in a new one in front of it
+        f(p);
+        ++n;
+      }
+      // release the head bag if it has been drained
+      if (head != nullptr && head->size == 0)
+      {
+        auto b = head;
+        head = b->next;
+        release_bag(b);
+      }
+      return n;
+    }
+
+    // Moves all nodes of other to the front of this list; the free bags remain in other.
+    void splice(retire_list& other)
+    {
+      if (other.head == nullptr)
+        return;
+
+      auto last = other.head;
+      while (last->next != nullptr)
+        last = last->next;
+      last->next = head;
+      head = other.head;
+      count += other.count;
+      other.head = nullptr;
+      other.count = 0;
+    }
+
+    // Moves all nodes into a new list; the free bags remain in this list.
+    retire_list take_nodes()
+    {
+      retire_list result;
+      std::swap(result.head, head);
+      std::swap(result.count, count);
+      return result;
+    }
+
+    void delete_objects()
+    {
+      consume([](deletable_object* p) { p->delete_self(); });
+    }
+
+  private:
+    // 62 pointers + size + next -> 512 bytes, i.e., exactly 8 cache lines
+    struct alignas(64) bag : aligned_object<bag>
+    {
+      static constexpr std::size_t capacity = 62;
+      deletable_object* nodes[capacity];
+      std::size_t size = 0;
+      bag* next = nullptr;
+    };
+
+    // the max. number of empty bags we keep for later reuse
+    static constexpr std::size_t max_free_bags = 8;
+    // how many nodes ahead we prefetch while consuming the list
+    static constexpr std::size_t prefetch_distance = 4;
+
+    bag* allocate_bag()
+    {
+      if (free_bags == nullptr)
+        return new bag();
+
+      auto result = free_bags;
+      free_bags = result->next;
+      --number_of_free_bags;
+      result->size = 0;
+      return result;
+    }
+
+    void release_bag(bag* b)
+    {
+      if (number_of_free_bags == max_free_bags)
+      {
+        delete b;
+        return;
+      }
+      b->next = free_bags;
+      free_bags = b;
+      ++number_of_free_bags;
+    }
+
+    static void free(bag* b)
+    {
+      while (b != nullptr)
+      {
+        auto next = b->next;
+        delete b;
+        b = next;
+      }
+    }
+
+    bag* head = nullptr;
+    bag* free_bags = nullptr;
+    std::size_t number_of_free_bags = 0;
+    std::size_t count = 0;
+  };
+}}
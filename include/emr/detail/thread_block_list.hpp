@@ -132,7 +132,7 @@ public:
     do
     {
       last->next = h;
-      // (4) - this releas-CAS synchronizes-with the acquire-exchange (5)
+      // (4) - this releas-CAS synchronizes-with the acquire-exchange (5) and the acquire-load/CAS (8, 9)
     } while (!abandoned_retired_nodes.compare_exchange_weak(h, obj,
         std::memory_order_release, std::memory_order_relaxed));
   }
@@ -146,6 +146,30 @@ public:
     return abandoned_retired_nodes.exchange(nullptr, std::memory_order_acquire);
   }
 
+  // Adopts only the object that has been abandoned last (its next pointer is reset).
+  // There is at most one thread at a time that removes objects this way - concurrent calls
+  // simply return nullptr instead of waiting. This avoids the ABA problem of a lock-free pop.
+  // Note: must not be mixed with adopt_abandoned_retired_nodes on the same list.
+  detail::deletable_object* try_adopt_abandoned_retired_node()
+  {
+    if (abandoned_retired_nodes.load(std::memory_order_relaxed) == nullptr ||
+        is_adopting.exchange(true, std::memory_order_acquire))
+      return nullptr;
+
+    // (8) - this acquire-load synchronizes-with the release-CAS (4)
+    auto result = abandoned_retired_nodes.load(std::memory_order_acquire);
+    // (9) - this acquire-CAS synchronizes-with the release-CAS (4)
+    while (result != nullptr &&
+           !abandoned_retired_nodes.compare_exchange_weak(result, result->next,
+                                                          std::memory_order_acquire, std::memory_order_acquire))
+      ;
+    is_adopting.store(false, std::memory_order_release);
+
+    if (result != nullptr)
+      result->next = nullptr;
+    return result;
+  }
+
 private:
   void add_entry(T* node)
   {
@@ -174,9 +198,10 @@ private:
     return result;
   }
 
-  std::atomic<T*> head;
+  std::atomic<T*> head{nullptr};
 
-  alignas(64) std::atomic<detail::deletable_object*> abandoned_retired_nodes;
+  alignas(64) std::atomic<detail::deletable_object*> abandoned_retired_nodes{nullptr};
+  std::atomic<bool> is_adopting{false};
 };
 
 }}
@@ -5,6 +5,9 @@
 #include <emr/detail/guard_ptr.hpp>
 #include "emr/detail/allocation_tracker.hpp"
 
+#include <type_traits>
+#include <utility>
+
 namespace emr {
 
   // This is a dummy implementation of the reclamation interface that
@@ -30,6 +33,14 @@ namespace emr {
 
     class region_guard {};
 
+    // there is nothing to flush, since retired objects are simply leaked
+    static void synchronize() {}
+    static bool try_flush() { return true; }
+
+    // f is never called - the callable (including its captures) is leaked just like retired objects
+    template <class Func>
+    static void retire(Func&& f) { new std::decay_t<Func>(std::forward<Func>(f)); }
+
     template <class T, class MarkedPtr>
     class guard_ptr;
 
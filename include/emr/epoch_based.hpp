@@ -5,9 +5,15 @@
 #include <emr/detail/deletable_object.hpp>
 #include <emr/detail/thread_block_list.hpp>
 #include <emr/detail/allocation_tracker.hpp>
+#include <emr/detail/background_reclaimer.hpp>
+#include <emr/detail/deferred_callback.hpp>
+#include <emr/detail/incremental_reclaimer.hpp>
+#include <emr/detail/reclamation_budget.hpp>
 
 #include <emr/acquire_guard.hpp>
 
+#include <cstdint>
+
 namespace emr {
 
   template <std::size_t UpdateThreshold>
@@ -25,14 +31,38 @@ namespace emr {
     template <class T, std::size_t N = T::number_of_mark_bits>
     using concurrent_ptr = emr::detail::concurrent_ptr<T, N, guard_ptr>;
 
+    using background_reclamation = detail::background_reclaimer<epoch_based>;
+    using incremental_reclamation = detail::incremental_reclaimer<epoch_based>;
+    using memory_budget = detail::reclamation_budget<epoch_based>;
+
+    // Waits until the global epoch has been advanced often enough for all nodes retired by the
+    // calling thread to become safe to reclaim, and deletes them. Abandoned nodes are adopted on the
+    // way, but while another thread is adopting some, these are left to that thread.
+    // The epoch can only advance once all threads inside a critical region have observed it,
+    // so the calling thread itself must not hold a guard_ptr.
+    static void synchronize();
+
+    // Tries to advance the global epoch once (without waiting for other threads) and deletes all
+    // retired nodes of the calling thread that are safe to reclaim. Returns true if none are left.
+    static bool try_flush();
+
+    // Defers the call of f until all threads that are currently inside a critical region have
+    // left it (like call_rcu). This allows to retire objects that cannot be reclaimed via a
+    // guard_ptr, e.g., buffers that are only reachable through some node.
+    template <class Func>
+    static void retire(Func&& f);
+
     ALLOCATION_TRACKER;
   private:
-    static constexpr unsigned number_epochs = 3;
+    // Epochs are monotonically increasing (a 64bit counter does not overflow in practice).
+    using epoch_t = std::uint64_t;
+
+    static constexpr epoch_t number_epochs = 3;
 
     struct thread_data;
     struct thread_control_block;
 
-    static std::atomic<unsigned> global_epoch;
+    static std::atomic<epoch_t> global_epoch;
     static detail::thread_block_list<thread_control_block> global_thread_block_list;
     static thread_data& local_thread_data();
 
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace emr {
+
+// A fixed-size array of guard_ptrs that reserves the reclaimer specific resources of all its
+// guards (e.g., hazard pointers) once on construction and keeps them until it is destroyed.
+// The guards can be re-pointed (acquire) and rotated (swap) without allocating and releasing
+// these resources over and over again, which is useful for traversals that hand over nodes
+// from one guard to another.
+// For reclaimers that do not need any per-guard resources (like the epoch based ones) this
+// is simply an array of guard_ptrs.
+template <class GuardPtr, std::size_t K>
+class guard_array
+{
+public:
+  guard_array()
+  {
+    for (auto& guard : guards)
+      guard.reserve();
+  }
+
+  guard_array(const guard_array&) = delete;
+  guard_array& operator=(const guard_array&) = delete;
+
+  GuardPtr& operator[](std::size_t idx) noexcept { return guards[idx]; }
+  const GuardPtr& operator[](std::size_t idx) const noexcept { return guards[idx]; }
+
+  static constexpr std::size_t size() noexcept { return K; }
+
+private:
+  GuardPtr guards[K];
+};
+
+}
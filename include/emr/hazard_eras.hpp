@@ -0,0 +1,185 @@
+#pragma once
+
+#include <emr/detail/concurrent_ptr.hpp>
+#include <emr/detail/guard_ptr.hpp>
+#include <emr/detail/deletable_object.hpp>
+#include <emr/detail/thread_block_list.hpp>
+#include <emr/detail/allocation_tracker.hpp>
+#include <emr/detail/background_reclaimer.hpp>
+#include <emr/detail/reclamation_budget.hpp>
+#include <emr/detail/deferred_callback.hpp>
+
+#include <emr/acquire_guard.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace emr {
+
+  class bad_hazard_era_alloc : public std::runtime_error
+  {
+    using std::runtime_error::runtime_error;
+  };
+
+  // Hazard Eras (Ramalhete and Correia) - instead of publishing the pointer of every object
+  // that is accessed, a thread publishes the current era. Since the global era clock only
+  // advances when an object gets retired, a traversal only has to publish a new value (and
+  // pay for the fence) when the clock has changed in the meantime.
+  // Each object records the era of its allocation and the era of its retirement; an object can
+  // be reclaimed if no thread has published an era in this range.
+  //
+  // K is the number of era slots per thread (i.e., the max. number of concurrent guard_ptrs per thread),
+  // a thread triggers a scan once it has more than A * K * number_of_threads + B retired nodes.
+  template <std::size_t K = 2, std::size_t A = 2, std::size_t B = 100>
+  class hazard_eras
+  {
+    template <class T, class MarkedPtr>
+    class guard_ptr;
+
+  public:
+    template <class T, std::size_t N = 0, class Deleter = std::default_delete<T>>
+    class enable_concurrent_ptr;
+
+    class region_guard {};
+
+    template <class T, std::size_t N = T::number_of_mark_bits>
+    using concurrent_ptr = emr::detail::concurrent_ptr<T, N, guard_ptr>;
+
+    static std::size_t retired_nodes_threshold()
+    {
+      return A * K * number_of_active_threads.load(std::memory_order_relaxed) + B;
+    }
+
+    using background_reclamation = detail::background_reclaimer<hazard_eras>;
+    using memory_budget = detail::reclamation_budget<hazard_eras>;
+
+    // Scans the published eras until all nodes retired by the calling thread (and all currently
+    // abandoned nodes) have been reclaimed. Must not be called while the calling thread holds a
+    // guard_ptr, since its own eras might protect some of these nodes.
+    static void synchronize();
+
+    // Performs a single scan and returns true if all retired nodes of the calling thread
+    // could be reclaimed.
+    static bool try_flush();
+
+    // Defers the call of f until no thread protects an era that was published before the call
+    // (like call_rcu), e.g., to free a buffer that is only reachable through some node.
+    template <class Func>
+    static void retire(Func&& f);
+
+    ALLOCATION_TRACKER;
+  private:
+    using era_t = std::uint64_t;
+    static constexpr era_t no_era = 0;
+
+    struct deletable_object_with_eras;
+    struct thread_control_block;
+    struct thread_data;
+
+    static std::atomic<era_t> era_clock;
+    static std::atomic<std::size_t> number_of_active_threads;
+    static detail::thread_block_list<thread_control_block> global_thread_block_list;
+    static thread_data& local_thread_data();
+
+    ALLOCATION_TRACKING_FUNCTIONS;
+  };
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  struct hazard_eras<K, A, B>::deletable_object_with_eras : detail::deletable_object
+  {
+  protected:
+    deletable_object_with_eras() noexcept :
+      // (1) - this acquire-load synchronizes-with the seq_cst-fetch-add (11)
+      birth_era(era_clock.load(std::memory_order_acquire))
+    {}
+    // a copy is a new object, so it must get its own birth era
+    deletable_object_with_eras(const deletable_object_with_eras&) noexcept :
+      deletable_object_with_eras()
+    {}
+    deletable_object_with_eras& operator=(const deletable_object_with_eras&) noexcept { return *this; }
+    // for objects that are not reachable via a concurrent_ptr (e.g., retired callbacks)
+    explicit deletable_object_with_eras(era_t birth_era) noexcept :
+      birth_era(birth_era)
+    {}
+    ~deletable_object_with_eras() = default;
+
+  private:
+    era_t birth_era;
+    era_t retire_era = no_era;
+    friend class hazard_eras;
+  };
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, std::size_t N, class Deleter>
+  class hazard_eras<K, A, B>::enable_concurrent_ptr :
+    private detail::deletable_object_impl<T, Deleter, deletable_object_with_eras>,
+    private detail::tracked_object<hazard_eras>
+  {
+  public:
+    static constexpr std::size_t number_of_mark_bits = N;
+  protected:
+    enable_concurrent_ptr() noexcept = default;
+    enable_concurrent_ptr(const enable_concurrent_ptr&) noexcept = default;
+    enable_concurrent_ptr(enable_concurrent_ptr&&) noexcept = default;
+    enable_concurrent_ptr& operator=(const enable_concurrent_ptr&) noexcept = default;
+    enable_concurrent_ptr& operator=(enable_concurrent_ptr&&) noexcept = default;
+    ~enable_concurrent_ptr() noexcept = default;
+  private:
+    friend detail::deletable_object_impl<T, Deleter, deletable_object_with_eras>;
+
+    template <class, class>
+    friend class guard_ptr;
+  };
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  class hazard_eras<K, A, B>::guard_ptr : public detail::guard_ptr<T, MarkedPtr, guard_ptr<T, MarkedPtr>>
+  {
+    using base = detail::guard_ptr<T, MarkedPtr, guard_ptr>;
+    using Deleter = typename T::Deleter;
+  public:
+    guard_ptr() noexcept = default;
+
+    // Guard a marked ptr.
+    guard_ptr(const MarkedPtr& p);
+    explicit guard_ptr(const guard_ptr& p);
+    guard_ptr(guard_ptr&& p) noexcept;
+    ~guard_ptr();
+
+    guard_ptr& operator=(const guard_ptr& p);
+    guard_ptr& operator=(guard_ptr&& p) noexcept;
+
+    // Atomically take snapshot of p, and *if* it points to unreclaimed object, acquire shared ownership of it.
+    void acquire(concurrent_ptr<T>& p, std::memory_order order = std::memory_order_seq_cst);
+
+    // Like acquire, but quit early if a snapshot != expected.
+    bool acquire_if_equal(concurrent_ptr<T>& p,
+                          const MarkedPtr& expected,
+                          std::memory_order order = std::memory_order_seq_cst);
+
+    // Release ownership. Postcondition: get() == nullptr.
+    void reset() noexcept;
+
+    // Reset. Deleter d will be applied some time after all owners release their ownership.
+    void reclaim(Deleter d = Deleter()) noexcept;
+
+    // Allocate an era slot and keep it until this guard is destroyed, even when it gets reset.
+    void reserve();
+
+  private:
+    using enable_concurrent_ptr = hazard_eras::enable_concurrent_ptr<T, MarkedPtr::number_of_mark_bits, Deleter>;
+
+    friend base;
+    void do_swap(guard_ptr& g) noexcept;
+
+    void protect_era(era_t era);
+
+    std::atomic<era_t>* slot = nullptr;
+    bool reserved = false;
+  };
+}
+
+#define HAZARD_ERAS_IMPL
+#include "hazard_eras_impl.hpp"
+#undef HAZARD_ERAS_IMPL
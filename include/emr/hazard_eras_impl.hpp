@@ -0,0 +1,467 @@
+#ifndef HAZARD_ERAS_IMPL
+#error "This is an impl file and must not be included directly!"
+#endif
+
+#include "detail/aligned_object.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace emr {
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::guard_ptr(const MarkedPtr& p) :
+    base(p)
+  {
+    if (this->ptr.get() != nullptr)
+      // (2) - this acquire-load synchronizes-with the seq_cst-fetch-add (11)
+      protect_era(era_clock.load(std::memory_order_acquire));
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::guard_ptr(const guard_ptr& p) :
+    base(p.ptr)
+  {
+    // we have to use the same era as p - the object might already be retired,
+    // so the current era is not necessarily covered by its lifetime.
+    if (this->ptr.get() != nullptr)
+      protect_era(p.slot->load(std::memory_order_relaxed));
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::guard_ptr(guard_ptr&& p) noexcept :
+    base(p.ptr),
+    slot(p.slot)
+  {
+    p.ptr.reset();
+    p.slot = nullptr;
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  auto hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::operator=(const guard_ptr& p)
+    -> guard_ptr&
+  {
+    if (&p == this)
+      return *this;
+
+    if (p.ptr.get() == nullptr)
+    {
+      reset();
+      return *this;
+    }
+
+    protect_era(p.slot->load(std::memory_order_relaxed));
+    this->ptr = p.ptr;
+    return *this;
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::~guard_ptr()
+  {
+    // the base class only calls reset, which does not release a reserved slot.
+    reserved = false;
+    reset();
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  auto hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::operator=(guard_ptr&& p) noexcept
+    -> guard_ptr&
+  {
+    if (&p == this)
+      return *this;
+
+    // we take over p's slot, so we have to release our own one (even if it is reserved)
+    local_thread_data().release_slot(slot);
+    this->ptr = std::move(p.ptr);
+    slot = p.slot;
+    p.ptr.reset();
+    p.slot = nullptr;
+    return *this;
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  void hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::acquire(concurrent_ptr<T>& p,
+    std::memory_order order)
+  {
+    if (p.load(std::memory_order_relaxed) == nullptr)
+    {
+      reset();
+      return;
+    }
+
+    if (slot == nullptr)
+      slot = local_thread_data().alloc_slot();
+
+    // as long as the era clock does not change we can keep using the era that is already
+    // published in our slot, so we only have to pay for publishing a new era when some
+    // other thread has retired a node in the meantime.
+    auto prev_era = slot->load(std::memory_order_relaxed);
+    for (;;)
+    {
+      // (3) - this load operation potentially synchronizes-with any release operation on p.
+      auto ptr = p.load(order);
+      if (ptr == nullptr)
+      {
+        reset();
+        return;
+      }
+
+      // (4) - this acquire-load synchronizes-with the seq_cst-fetch-add (11)
+      auto era = era_clock.load(std::memory_order_acquire);
+      if (era == prev_era)
+      {
+        this->ptr = ptr;
+        return;
+      }
+
+      protect_era(era);
+      prev_era = era;
+    }
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  bool hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::acquire_if_equal(
+    concurrent_ptr<T>& p,
+    const MarkedPtr& expected,
+    std::memory_order order)
+  {
+    auto p1 = p.load(std::memory_order_relaxed);
+    if (p1 == nullptr || p1 != expected)
+    {
+      reset();
+      return p1 == expected;
+    }
+
+    if (slot == nullptr)
+      slot = local_thread_data().alloc_slot();
+
+    auto prev_era = slot->load(std::memory_order_relaxed);
+    for (;;)
+    {
+      // (5) - this load operation potentially synchronizes-with any release operation on p.
+      auto ptr = p.load(order);
+      if (ptr != expected)
+      {
+        reset();
+        return false;
+      }
+
+      // (6) - this acquire-load synchronizes-with the seq_cst-fetch-add (11)
+      auto era = era_clock.load(std::memory_order_acquire);
+      if (era == prev_era)
+      {
+        this->ptr = ptr;
+        return true;
+      }
+
+      protect_era(era);
+      prev_era = era;
+    }
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  void hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::reset() noexcept
+  {
+    // A reserved slot keeps its era published, so a subsequent acquire does not have to publish
+    // it again as long as the era clock has not changed. This can delay the reclamation of
+    // nodes that have been retired in that era until the guard is destroyed or re-pointed.
+    if (!reserved)
+      local_thread_data().release_slot(slot);
+    this->ptr.reset();
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  void hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::reserve()
+  {
+    if (slot == nullptr)
+      slot = local_thread_data().alloc_slot();
+    reserved = true;
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  void hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::do_swap(guard_ptr& g) noexcept
+  {
+    std::swap(slot, g.slot);
+    std::swap(reserved, g.reserved);
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  void hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept
+  {
+    auto p = this->ptr.get();
+    reset();
+    p->set_deleter(std::move(d));
+    if (local_thread_data().add_retired_node(p) >= memory_budget::threshold(retired_nodes_threshold()))
+      local_thread_data().scan();
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class T, class MarkedPtr>
+  void hazard_eras<K, A, B>::guard_ptr<T, MarkedPtr>::protect_era(era_t era)
+  {
+    if (slot == nullptr)
+      slot = local_thread_data().alloc_slot();
+
+    // (7) - this relaxed store can be part of a release sequence headed by (9)
+    slot->store(era, std::memory_order_relaxed);
+    // (8) - this seq_cst-fence enforces a total order with the seq_cst-fence (12)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  struct alignas(64) hazard_eras<K, A, B>::thread_control_block :
+    detail::thread_block_list<thread_control_block>::entry,
+    detail::aligned_object<thread_control_block>
+  {
+    thread_control_block()
+    {
+      for (auto& era : eras)
+        era.store(no_era, std::memory_order_relaxed);
+    }
+
+    void gather_protected_eras(std::vector<era_t>& protected_eras) const
+    {
+      for (auto& era : eras)
+      {
+        auto v = era.load(std::memory_order_relaxed);
+        if (v != no_era)
+          protected_eras.push_back(v);
+      }
+    }
+
+    std::atomic<era_t> eras[K];
+  };
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  struct alignas(64) hazard_eras<K, A, B>::thread_data : detail::aligned_object<thread_data>
+  {
+    ~thread_data()
+    {
+      if (retire_list != nullptr)
+      {
+        scan();
+        if (retire_list != nullptr)
+          global_thread_block_list.abandon_retired_nodes(retire_list);
+      }
+
+      if (control_block != nullptr)
+      {
+        number_of_active_threads.fetch_sub(1, std::memory_order_relaxed);
+        global_thread_block_list.release_entry(control_block);
+      }
+    }
+
+    std::atomic<era_t>* alloc_slot()
+    {
+      ensure_has_control_block();
+      if (number_of_free_slots == 0)
+        throw bad_hazard_era_alloc("hazard era slots exceeded");
+      return &control_block->eras[free_slots[--number_of_free_slots]];
+    }
+
+    void release_slot(std::atomic<era_t>*& slot) noexcept
+    {
+      if (slot == nullptr)
+        return;
+
+      // (9) - this release-store synchronizes-with the acquire-fence (13)
+      slot->store(no_era, std::memory_order_release);
+      free_slots[number_of_free_slots++] = static_cast<unsigned>(slot - control_block->eras);
+      slot = nullptr;
+    }
+
+    std::size_t add_retired_node(deletable_object_with_eras* p)
+    {
+      // (10) - this seq_cst-load is ordered with the seq_cst-fetch-add (11)
+      p->retire_era = era_clock.load(std::memory_order_seq_cst);
+      // we only have to advance the era clock if no other thread did so in the meantime
+      if (era_clock.load(std::memory_order_relaxed) == p->retire_era)
+        // (11) - this seq_cst-fetch-add synchronizes-with the acquire-loads (1, 2, 4, 6)
+        era_clock.fetch_add(1, std::memory_order_seq_cst);
+
+      add_to_retire_list(p);
+      budget_counter.retired();
+      return number_of_retired_nodes;
+    }
+
+    void scan()
+    {
+      // A node's destructor can retire further nodes and thereby trigger another scan while
+      // we are still using protected_eras. Such nodes simply remain in the retire_list
+      // and are handled by the next scan.
+      if (is_scanning)
+        return;
+      is_scanning = true;
+
+      protected_eras.clear();
+      protected_eras.reserve(K * number_of_active_threads.load(std::memory_order_relaxed));
+
+      // (12) - this seq_cst-fence enforces a total order with the seq_cst-fence (8)
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      auto adopted_nodes = global_thread_block_list.adopt_abandoned_retired_nodes();
+
+      std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(),
+        [this](const auto& entry)
+        {
+          if (entry.is_active())
+            entry.gather_protected_eras(protected_eras);
+        });
+
+      // (13) - this acquire-fence synchronizes-with the release-store (9)
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      std::sort(protected_eras.begin(), protected_eras.end());
+
+      auto list = retire_list;
+      retire_list = nullptr;
+      number_of_retired_nodes = 0;
+      reclaim_nodes(list);
+      reclaim_nodes(adopted_nodes);
+      is_scanning = false;
+    }
+
+    bool try_flush()
+    {
+      if (is_scanning)
+        return false; // called by the destructor of a node we are currently reclaiming
+      scan();
+      return retire_list == nullptr;
+    }
+
+  private:
+    void ensure_has_control_block()
+    {
+      if (control_block == nullptr)
+      {
+        control_block = global_thread_block_list.acquire_entry();
+        number_of_active_threads.fetch_add(1, std::memory_order_relaxed);
+        for (unsigned i = 0; i < K; ++i)
+          free_slots[i] = K - i - 1;
+        number_of_free_slots = K;
+      }
+    }
+
+    void add_to_retire_list(detail::deletable_object* p)
+    {
+      p->next = retire_list;
+      retire_list = p;
+      ++number_of_retired_nodes;
+    }
+
+    bool is_protected(const deletable_object_with_eras* p) const
+    {
+      // p is protected if some thread has published an era in [birth_era, retire_era]
+      auto it = std::lower_bound(protected_eras.begin(), protected_eras.end(), p->birth_era);
+      return it != protected_eras.end() && *it <= p->retire_era;
+    }
+
+    void reclaim_nodes(detail::deletable_object* list)
+    {
+      // if background reclamation is enabled, unprotected nodes are collected and deleted by the background thread
+      detail::deletable_object* reclaimable_nodes = nullptr;
+      while (list != nullptr)
+      {
+        auto cur = static_cast<deletable_object_with_eras*>(list);
+        list = list->next;
+
+        if (is_protected(cur))
+        {
+          add_to_retire_list(cur);
+          continue;
+        }
+
+        budget_counter.released();
+        if (background_reclamation::is_enabled())
+        {
+          cur->next = reclaimable_nodes;
+          reclaimable_nodes = cur;
+        }
+        else
+          cur->delete_self();
+      }
+      background_reclamation::delete_objects(reclaimable_nodes);
+    }
+
+    detail::deletable_object* retire_list = nullptr;
+    std::size_t number_of_retired_nodes = 0;
+
+    thread_control_block* control_block = nullptr;
+    unsigned free_slots[K];
+    unsigned number_of_free_slots = 0;
+
+    std::vector<era_t> protected_eras;
+    bool is_scanning = false;
+    typename memory_budget::thread_counter budget_counter;
+
+    friend class hazard_eras;
+    ALLOCATION_COUNTER(hazard_eras);
+  };
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  std::atomic<typename hazard_eras<K, A, B>::era_t> hazard_eras<K, A, B>::era_clock{1};
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  std::atomic<std::size_t> hazard_eras<K, A, B>::number_of_active_threads;
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  detail::thread_block_list<typename hazard_eras<K, A, B>::thread_control_block>
+    hazard_eras<K, A, B>::global_thread_block_list;
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  void hazard_eras<K, A, B>::synchronize()
+  {
+    while (!local_thread_data().try_flush())
+      std::this_thread::yield();
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  bool hazard_eras<K, A, B>::try_flush()
+  {
+    return local_thread_data().try_flush();
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  template <class Func>
+  void hazard_eras<K, A, B>::retire(Func&& f)
+  {
+    // The callback is born in the very first era, so it is protected by every era that has
+    // been published before it gets retired.
+    const era_t first_era = 1;
+    auto node = detail::deferred_callback<deletable_object_with_eras>::create(std::forward<Func>(f), first_era);
+    if (local_thread_data().add_retired_node(node) >= memory_budget::threshold(retired_nodes_threshold()))
+      local_thread_data().scan();
+  }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  inline typename hazard_eras<K, A, B>::thread_data& hazard_eras<K, A, B>::local_thread_data()
+  {
+    static thread_local thread_data local_thread_data;
+    return local_thread_data;
+  }
+
+#ifdef TRACK_ALLOCATIONS
+  template <std::size_t K, std::size_t A, std::size_t B>
+  emr::detail::allocation_tracker hazard_eras<K, A, B>::allocation_tracker;
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  inline void hazard_eras<K, A, B>::count_allocation()
+  { local_thread_data().allocation_counter.count_allocation(); }
+
+  template <std::size_t K, std::size_t A, std::size_t B>
+  inline void hazard_eras<K, A, B>::count_reclamation()
+  { local_thread_data().allocation_counter.count_reclamation(); }
+#endif
+}
@@ -5,11 +5,16 @@
 #include <emr/detail/deletable_object.hpp>
 #include <emr/detail/thread_block_list.hpp>
 #include <emr/detail/allocation_tracker.hpp>
+#include <emr/detail/background_reclaimer.hpp>
+#include <emr/detail/reclamation_budget.hpp>
+#include <emr/detail/deferred_callback.hpp>
+#include <emr/detail/asymmetric_fence.hpp>
 
 #include <emr/acquire_guard.hpp>
 
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
 
 namespace emr {
 
@@ -21,11 +26,46 @@ namespace emr {
   template <class Policy, class Derived>
   struct basic_hp_thread_control_block;
 
-  template <size_t K_, size_t A, size_t B, template <class> class ThreadControlBlock>
+  // The retire threshold decides when a thread has to scan its retired nodes. Every thread has its
+  // own instance; after each scan it gets notified about the number of scanned and reclaimed nodes.
+
+  // Uses the static Policy::retired_nodes_threshold().
+  template <class Policy>
+  struct fixed_retire_threshold
+  {
+    size_t get() const { return Policy::retired_nodes_threshold(); }
+    void update(size_t, size_t) {}
+  };
+
+  // Adapts the threshold of each thread based on the yield of its scans (i.e., the fraction of the
+  // scanned nodes that could be reclaimed). If only few nodes can be reclaimed, most of the scan is
+  // wasted work, so the threshold is increased; if almost all nodes are reclaimed, the threshold is
+  // decreased so that memory is freed sooner.
+  // The threshold is always at least number_of_active_hazard_pointers() + Policy::min_retired_nodes
+  // (otherwise a scan might not be able to reclaim anything), and at most Policy::max_retired_nodes
+  // (the memory budget of a thread) unless that is below the lower bound.
+  template <class Policy>
+  class adaptive_retire_threshold
+  {
+  public:
+    size_t get() const { return threshold; }
+    void update(size_t scanned_nodes, size_t reclaimed_nodes);
+  private:
+    size_t threshold = Policy::retired_nodes_threshold();
+  };
+
+  // If AsymmetricFence is true, publishing a hazard pointer only requires a compiler barrier while
+  // scan() issues a process-wide memory barrier (membarrier), which is beneficial for read-mostly workloads.
+  template <size_t K_, size_t A, size_t B, template <class> class ThreadControlBlock, bool AsymmetricFence = false>
   struct generic_hazard_pointer_policy
   {
     static constexpr size_t K = K_;
-    
+
+    using fence = std::conditional_t<AsymmetricFence, detail::asymmetric_fence, detail::symmetric_fence>;
+
+    template <class Policy>
+    using retire_threshold = fixed_retire_threshold<Policy>;
+
     static size_t retired_nodes_threshold()
     {
       return A * number_of_active_hazard_pointers() + B;
@@ -56,6 +96,27 @@ namespace emr {
   template <size_t K = 2, size_t A = 2, size_t B = 100>
   using dynamic_hazard_pointer_policy = generic_hazard_pointer_policy<K, A, B, dynamic_hp_thread_control_block>;
 
+  // Starts with the threshold A * number_of_active_hazard_pointers() + B, but each thread adapts its
+  // threshold based on its scan yield and the MaxRetiredNodes memory budget (see adaptive_retire_threshold).
+  template <size_t K = 2, size_t MinRetiredNodes = 10, size_t MaxRetiredNodes = 10000, size_t A = 2, size_t B = 100,
+            template <class> class ThreadControlBlock = dynamic_hp_thread_control_block>
+  struct adaptive_hazard_pointer_policy : generic_hazard_pointer_policy<K, A, B, ThreadControlBlock>
+  {
+    static constexpr size_t min_retired_nodes = MinRetiredNodes;
+    static constexpr size_t max_retired_nodes = MaxRetiredNodes;
+
+    template <class Policy>
+    using retire_threshold = adaptive_retire_threshold<Policy>;
+  };
+
+  template <size_t K = 2, size_t A = 2, size_t B = 100>
+  using asymmetric_static_hazard_pointer_policy =
+    generic_hazard_pointer_policy<K, A, B, static_hp_thread_control_block, true>;
+
+  template <size_t K = 2, size_t A = 2, size_t B = 100>
+  using asymmetric_dynamic_hazard_pointer_policy =
+    generic_hazard_pointer_policy<K, A, B, dynamic_hp_thread_control_block, true>;
+
   template <typename Policy>
   class hazard_pointer
   {
@@ -74,13 +135,56 @@ namespace emr {
     template <class T, std::size_t N = T::number_of_mark_bits>
     using concurrent_ptr = emr::detail::concurrent_ptr<T, N, guard_ptr>;
 
+    // When enabled, scans are performed by a background thread (disabled by default).
+    using background_reclamation = detail::background_reclaimer<hazard_pointer>;
+    using memory_budget = detail::reclamation_budget<hazard_pointer>;
+
+    // Scans the hazard pointers until all nodes retired by the calling thread have been reclaimed,
+    // i.e., until no thread protects any of them anymore. Abandoned nodes are adopted on the way,
+    // but while another thread is adopting some, these are left to that thread.
+    // The scans are performed by the calling thread even if background reclamation is enabled.
+    // The calling thread must not hold a guard_ptr to a retired node, otherwise this never returns.
+    static void synchronize();
+
+    // Performs a single scan and returns true if all retired nodes of the calling thread
+    // could be reclaimed.
+    static bool try_flush();
+
+    // Defers the call of f (like call_rcu), e.g., to free a buffer that is only reachable through
+    // some node. Since f is not associated with any object that could be protected, it is called
+    // once every hazard pointer that protected some object at the time of the call has been
+    // changed or released at least once.
+    template <class Func>
+    static void retire(Func&& f);
+
+    struct retire_threshold_statistics
+    {
+      size_t updates = 0;
+      double avg_threshold = 0;
+      size_t max_threshold = 0;
+    };
+    // The retire thresholds the threads have used after their scans (e.g., to evaluate the
+    // adaptive_retire_threshold). Every thread records its own thresholds in its control block.
+    static retire_threshold_statistics get_retire_threshold_statistics();
+
     ALLOCATION_TRACKER;
   private:
     struct thread_data;
+    struct retired_nodes_batch;
+    struct retired_callbacks_batch;
+    struct protected_pointer_snapshot;
+    class protected_slots;
+    struct abandoned_nodes;
 
     static detail::thread_block_list<thread_control_block> global_thread_block_list;
+    static std::atomic<protected_pointer_snapshot*> latest_snapshot;
+    static detail::thread_block_list<protected_pointer_snapshot> snapshot_pool;
+    static std::atomic<size_t> snapshot_generation;
     static thread_local thread_data local_thread_data;
 
+    // Used by the background thread, which does not share the snapshots of the scanning threads.
+    static void gather_protected_pointers(typename thread_control_block::protected_pointer_set& pointers);
+
     ALLOCATION_TRACKING_FUNCTIONS;
   };
 
@@ -119,6 +223,7 @@ namespace emr {
     guard_ptr(const MarkedPtr& p);
     explicit guard_ptr(const guard_ptr& p);
     guard_ptr(guard_ptr&& p) noexcept;
+    ~guard_ptr();
 
     guard_ptr& operator=(const guard_ptr& p) noexcept;
     guard_ptr& operator=(guard_ptr&& p) noexcept;
@@ -137,6 +242,9 @@ namespace emr {
     // Reset. Deleter d will be applied some time after all owners release their ownership.
     void reclaim(Deleter d = Deleter()) noexcept;
 
+    // Allocate a hazard pointer and keep it until this guard is destroyed, even when it gets reset.
+    void reserve();
+
   private:
     using enable_concurrent_ptr = hazard_pointer::enable_concurrent_ptr<T, MarkedPtr::number_of_mark_bits, Deleter>;
 
@@ -144,6 +252,7 @@ namespace emr {
     void do_swap(guard_ptr& g) noexcept;
 
     typename thread_control_block::hazard_pointer* hp = nullptr;
+    bool reserved = false;
   };
 }
 
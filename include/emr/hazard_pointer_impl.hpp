@@ -3,8 +3,12 @@
 #endif
 
 #include "detail/aligned_object.hpp"
+#include "detail/pointer_set.hpp"
+#include "detail/retire_list.hpp"
 #include <algorithm>
+#include <functional>
 #include <new>
+#include <thread>
 #include <vector>
 
 namespace emr {
@@ -53,6 +57,15 @@ namespace emr {
     return *this;
   }
 
+  template <typename Policy>
+  template <class T, class MarkedPtr>
+  hazard_pointer<Policy>::guard_ptr<T, MarkedPtr>::~guard_ptr()
+  {
+    // the base class only calls reset, which does not release a reserved hazard pointer.
+    reserved = false;
+    reset();
+  }
+
   template <typename Policy>
   template <class T, class MarkedPtr>
   auto hazard_pointer<Policy>::guard_ptr<T, MarkedPtr>::operator=(guard_ptr&& p) noexcept
@@ -61,7 +74,8 @@ namespace emr {
     if (&p == this)
       return *this;
 
-    reset();
+    // we take over p's hazard pointer, so we have to release our own one (even if it is reserved)
+    local_thread_data.release_hazard_pointer(hp);
     this->ptr = std::move(p.ptr);
     hp = p.hp;
     p.ptr.reset();
@@ -126,15 +140,28 @@ namespace emr {
   template <class T, class MarkedPtr>
   void hazard_pointer<Policy>::guard_ptr<T, MarkedPtr>::reset() noexcept
   {
-    local_thread_data.release_hazard_pointer(hp);
+    if (!reserved)
+      local_thread_data.release_hazard_pointer(hp);
+    else if (hp != nullptr)
+      hp->clear();
     this->ptr.reset();
   }
 
+  template <typename Policy>
+  template <class T, class MarkedPtr>
+  void hazard_pointer<Policy>::guard_ptr<T, MarkedPtr>::reserve()
+  {
+    if (hp == nullptr)
+      hp = local_thread_data.alloc_hazard_pointer();
+    reserved = true;
+  }
+
   template <typename Policy>
   template <class T, class MarkedPtr>
   void hazard_pointer<Policy>::guard_ptr<T, MarkedPtr>::do_swap(guard_ptr& g) noexcept
   {
     std::swap(hp, g.hp);
+    std::swap(reserved, g.reserved);
   }
 
   template <typename Policy>
@@ -144,7 +171,16 @@ namespace emr {
     auto p = this->ptr.get();
     reset();
     p->set_deleter(std::move(d));
-    if (local_thread_data.add_retired_node(p) >= Policy::retired_nodes_threshold())
+    if (local_thread_data.add_retired_node(p) >= memory_budget::threshold(local_thread_data.retire_threshold.get()))
+      local_thread_data.scan();
+  }
+
+  template <typename Policy>
+  template <class Func>
+  void hazard_pointer<Policy>::retire(Func&& f)
+  {
+    auto node = detail::deferred_callback<detail::deletable_object>::create(std::forward<Func>(f));
+    if (local_thread_data.add_retired_callback(node) >= memory_budget::threshold(local_thread_data.retire_threshold.get()))
       local_thread_data.scan();
   }
 
@@ -153,14 +189,16 @@ namespace emr {
     detail::thread_block_list<Derived>::entry,
     detail::aligned_object<basic_hp_thread_control_block<Policy, Derived>>
   {
+    using protected_pointer_set = detail::pointer_set<detail::deletable_object>;
+
     struct hazard_pointer
     {
       void set_object(detail::deletable_object* obj)
       {
-        // (3) - this relaxed store can be part of a release sequence headed by (5)
+        // (3) - this relaxed store can be part of a release sequence headed by (5, 6)
         value.store(reinterpret_cast<void**>(obj), std::memory_order_relaxed);
-        // (4) - this seq_cst-fence enforces a total order with the seq_cst-fence (8)
-        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // (4) - this light fence enforces a total order with the heavy fences (12, 14)
+        Policy::fence::light();
       }
 
       bool try_get_object(detail::deletable_object*& result) const
@@ -176,9 +214,16 @@ namespace emr {
 
       void set_link(hazard_pointer* link)
       {
-        // (5) - this release store synchronizes-with the acquire fence (9)
+        // (5) - this release store synchronizes-with the acquire fences (13, 15)
         value.store(detail::marked_ptr<void*, 1>(reinterpret_cast<void**>(link), 1), std::memory_order_release);
       }
+
+      void clear()
+      {
+        // (6) - this release store synchronizes-with the acquire fences (13, 15)
+        value.store(nullptr, std::memory_order_release);
+      }
+
       hazard_pointer* get_link() const
       {
         assert(is_link());
@@ -229,6 +274,19 @@ namespace emr {
       }
     }
 
+    // Only called by the owning thread, so no read-modify-write operations are required.
+    void record_retire_threshold(size_t threshold)
+    {
+      threshold_updates.store(threshold_updates.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      sum_of_thresholds.store(sum_of_thresholds.load(std::memory_order_relaxed) + threshold, std::memory_order_relaxed);
+      if (threshold > max_threshold.load(std::memory_order_relaxed))
+        max_threshold.store(threshold, std::memory_order_relaxed);
+    }
+
+    std::atomic<size_t> threshold_updates{0};
+    std::atomic<size_t> sum_of_thresholds{0};
+    std::atomic<size_t> max_threshold{0};
+
   protected:
     Derived& self() { return static_cast<Derived&>(*this); }
 
@@ -240,26 +298,41 @@ namespace emr {
     template <typename T>
     static hazard_pointer* initialize_block(T& block)
     {
-      auto begin = block.begin();
-      auto end = block.end() - 1; // the last element is handled specially, so loop only over n-1 entries
-      for (auto it = begin; it != end;)
+      return link_hazard_pointers(block.begin(), block.end(), block.initialize_next_block());
+    }
+
+    static hazard_pointer* link_hazard_pointers(hazard_pointer* begin, hazard_pointer* end, hazard_pointer* next_link)
+    {
+      auto last = end - 1; // the last element is handled specially, so loop only over n-1 entries
+      for (auto it = begin; it != last;)
       {
         auto next = it + 1;
         it->set_link(next);
         it = next;
       }
-      end->set_link(block.initialize_next_block());
+      last->set_link(next_link);
       return begin;
     }
 
-    static void gather_protected_pointers(std::vector<const detail::deletable_object*>& protected_ptrs,
+    static void gather_protected_pointers(protected_pointer_set& protected_ptrs,
       const hazard_pointer* begin, const hazard_pointer* end)
     {
       for (auto it = begin; it != end; ++it)
       {
         detail::deletable_object* obj;
         if (it->try_get_object(obj))
-          protected_ptrs.push_back(obj);
+          protected_ptrs.insert(obj);
+      }
+    }
+
+    template <typename Func>
+    static void for_each_protected_object(const hazard_pointer* begin, const hazard_pointer* end, Func& func)
+    {
+      for (auto it = begin; it != end; ++it)
+      {
+        detail::deletable_object* obj;
+        if (it->try_get_object(obj) && obj != nullptr)
+          func(*it, obj);
       }
     }
 
@@ -272,12 +345,20 @@ namespace emr {
   {
     using base = basic_hp_thread_control_block<Policy, static_hp_thread_control_block>;
     using hazard_pointer = typename base::hazard_pointer;
+    using protected_pointer_set = typename base::protected_pointer_set;
     friend base;
 
-    void gather_protected_pointers(std::vector<const detail::deletable_object*>& protected_ptrs) const
+    void gather_protected_pointers(protected_pointer_set& protected_ptrs) const
     {
       base::gather_protected_pointers(protected_ptrs, this->begin(), this->end());
     }
+
+    // Calls func(hazard_pointer, object) for each hazard pointer that currently protects an object.
+    template <typename Func>
+    void for_each_protected_object(Func&& func) const
+    {
+      base::for_each_protected_object(this->begin(), this->end(), func);
+    }
   private:
     hazard_pointer* need_more_hps() { throw bad_hazard_pointer_alloc("hazard pointer pool exceeded"); }
     constexpr size_t number_of_hps() const { return Policy::K; }
@@ -290,14 +371,46 @@ namespace emr {
   {
     using base = basic_hp_thread_control_block<Policy, dynamic_hp_thread_control_block>;
     using hazard_pointer = typename base::hazard_pointer;
+    using hint = typename base::hint;
+    using protected_pointer_set = typename base::protected_pointer_set;
     friend base;
 
-    void gather_protected_pointers(std::vector<const detail::deletable_object*>& protected_ptrs) const
+    void gather_protected_pointers(protected_pointer_set& protected_ptrs) const
     {
       gather_protected_pointers(*this, protected_ptrs);
     }
 
+    // Calls func(hazard_pointer, object) for each hazard pointer that currently protects an object.
+    template <typename Func>
+    void for_each_protected_object(Func&& func) const
+    {
+      for_each_protected_object(*this, func);
+    }
+
+    hazard_pointer* alloc_hazard_pointer(hint& hint)
+    {
+      auto result = base::alloc_hazard_pointer(hint);
+      if (++number_of_used_hps > max_used_hps)
+        max_used_hps = number_of_used_hps;
+      return result;
+    }
+
+    void release_hazard_pointer(hazard_pointer*& hp, hint& hint)
+    {
+      if (hp == nullptr)
+        return;
+
+      base::release_hazard_pointer(hp, hint);
+      --number_of_used_hps;
+      if (++releases_since_shrink == shrink_interval)
+        shrink(hint);
+    }
+
   private:
+    // every shrink_interval releases we check whether the hazard pointers of the most recently
+    // allocated blocks have been required during that time; if not, we remove those blocks.
+    static constexpr size_t shrink_interval = 1024;
+
     struct alignas(64) hazard_pointer_block : detail::aligned_object<hazard_pointer_block>
     {
       hazard_pointer_block(size_t size) : size(size) {}
@@ -308,16 +421,32 @@ namespace emr {
       const hazard_pointer* begin() const { return reinterpret_cast<const hazard_pointer*>(this + 1); }
       const hazard_pointer* end() const { return begin() + size; }
 
-      const hazard_pointer_block* next_block() const { return next; }
-      hazard_pointer* initialize_next_block() { return next ? base::initialize_block(*next) : nullptr; }
+      const hazard_pointer_block* next_block() const
+      {
+        // (10) - this acquire-load synchronizes-with the release-store (11)
+        return next.load(std::memory_order_acquire);
+      }
+      hazard_pointer* initialize_next_block()
+      {
+        auto n = next.load(std::memory_order_relaxed);
+        return n ? base::initialize_block(*n) : nullptr;
+      }
 
-      hazard_pointer_block* next = nullptr;
+      bool contains(const hazard_pointer* hp) const
+      {
+        return !std::less<const hazard_pointer*>()(hp, begin()) && std::less<const hazard_pointer*>()(hp, end());
+      }
+
+      // next is not changed while the block is in use, but a block that has been removed can be
+      // reused later, while concurrent scans might still be iterating over it.
+      std::atomic<hazard_pointer_block*> next{nullptr};
+      hazard_pointer_block* next_spare = nullptr;
       const size_t size;
     };
 
     const hazard_pointer_block* next_block() const
     {
-      // (6) - this acquire-load synchronizes-with the release-store (7)
+      // (7) - this acquire-load synchronizes-with the release-stores (8, 9)
       return hp_block.load(std::memory_order_acquire);
     }
     size_t number_of_hps() const { return total_number_of_hps; }
@@ -331,7 +460,7 @@ namespace emr {
     }
 
     template <typename T>
-    static void gather_protected_pointers(const T& block, std::vector<const detail::deletable_object*>& protected_ptrs)
+    static void gather_protected_pointers(const T& block, protected_pointer_set& protected_ptrs)
     {
       base::gather_protected_pointers(protected_ptrs, block.begin(), block.end());
 
@@ -340,6 +469,16 @@ namespace emr {
         gather_protected_pointers(*next, protected_ptrs);
     }
 
+    template <typename T, typename Func>
+    static void for_each_protected_object(const T& block, Func& func)
+    {
+      base::for_each_protected_object(block.begin(), block.end(), func);
+
+      auto next = block.next_block();
+      if (next)
+        for_each_protected_object(*next, func);
+    }
+
     static detail::deletable_object* as_internal_pointer(hazard_pointer* p)
     {
       // since we use the hazard pointer array to build our internal linked list of hazard pointers
@@ -350,22 +489,193 @@ namespace emr {
 
     hazard_pointer* allocate_new_hazard_pointer_block()
     {
-      size_t hps = std::max(static_cast<size_t>(Policy::K), total_number_of_hps / 2);
-      total_number_of_hps += hps;
-      Policy::number_of_active_hps.fetch_add(hps, std::memory_order_relaxed);
+      // we prefer to reuse a previously removed block over allocating a new one.
+      auto block = spare_blocks;
+      if (block != nullptr)
+        spare_blocks = block->next_spare;
+      else
+      {
+        size_t hps = std::max(static_cast<size_t>(Policy::K), total_number_of_hps / 2);
+        size_t buffer_size = sizeof(hazard_pointer_block) + hps * sizeof(hazard_pointer);
+        void* buffer = hazard_pointer_block::operator new(buffer_size);
+        block = ::new(buffer) hazard_pointer_block(hps);
+      }
+
+      total_number_of_hps += block->size;
+      Policy::number_of_active_hps.fetch_add(block->size, std::memory_order_relaxed);
 
-      size_t buffer_size = sizeof(hazard_pointer_block) + hps * sizeof(hazard_pointer);
-      void* buffer = hazard_pointer_block::operator new(buffer_size);
-      auto block = ::new(buffer) hazard_pointer_block(hps);
-      auto result = this->initialize_block(*block);
-      block->next = hp_block.load(std::memory_order_relaxed);
-      // (7) - this release-store synchronizes-with the acquire-load (6)
+      // we must not follow block->next here, since a reused block still points to its old successor.
+      auto result = base::link_hazard_pointers(block->begin(), block->end(), nullptr);
+      // (11) - this release-store synchronizes-with the acquire-load (10)
+      block->next.store(hp_block.load(std::memory_order_relaxed), std::memory_order_release);
+      // (8) - this release-store synchronizes-with the acquire-load (7)
       hp_block.store(block, std::memory_order_release);
       return result;
     }
 
+    void shrink(hint& hint)
+    {
+      releases_since_shrink = 0;
+      for (;;)
+      {
+        auto block = hp_block.load(std::memory_order_relaxed);
+        if (block == nullptr || max_used_hps > total_number_of_hps - block->size)
+          break;
+        if (!try_remove_block(block, hint))
+          break;
+      }
+      max_used_hps = number_of_used_hps;
+    }
+
+    bool try_remove_block(hazard_pointer_block* block, hint& hint)
+    {
+      // we can only remove the block if none of its hazard pointers is in use.
+      if (!std::all_of(block->begin(), block->end(), [](const hazard_pointer& hp) { return hp.is_link(); }))
+        return false;
+
+      // remove the block's hazard pointers from our free list
+      hazard_pointer* new_hint = nullptr;
+      hazard_pointer* last = nullptr;
+      for (auto hp = hint; hp != nullptr;)
+      {
+        auto next = hp->get_link();
+        if (!block->contains(hp))
+        {
+          if (last)
+            last->set_link(hp);
+          else
+            new_hint = hp;
+          last = hp;
+        }
+        hp = next;
+      }
+      if (last)
+        last->set_link(nullptr);
+      hint = new_hint;
+
+      // Concurrent scans might still iterate over this block, so we cannot free it. Instead we keep
+      // it for reuse; since all its hazard pointers are links it does not protect anything.
+      // (9) - this release-store synchronizes-with the acquire-load (7)
+      hp_block.store(block->next.load(std::memory_order_relaxed), std::memory_order_release);
+      total_number_of_hps -= block->size;
+      Policy::number_of_active_hps.fetch_sub(block->size, std::memory_order_relaxed);
+
+      block->next_spare = spare_blocks;
+      spare_blocks = block;
+      return true;
+    }
+
     size_t total_number_of_hps = Policy::K;
+    size_t number_of_used_hps = 0;
+    size_t max_used_hps = 0;
+    size_t releases_since_shrink = 0;
     std::atomic<hazard_pointer_block*> hp_block;
+    hazard_pointer_block* spare_blocks = nullptr;
+  };
+
+  // The protected pointers gathered by one scan. When several threads scan at the same
+  // time, they can share the most recent snapshot instead of all walking the hazard pointers.
+  // Snapshots are never freed, but recycled via snapshot_pool, so a thread may still increment the
+  // ref_count of a snapshot that has just been replaced as latest_snapshot; it then simply notices
+  // that the snapshot is no longer the latest one and drops its reference again.
+  template <typename Policy>
+  struct hazard_pointer<Policy>::protected_pointer_snapshot :
+    detail::thread_block_list<protected_pointer_snapshot>::entry
+  {
+    // the number of scans that use this snapshot, plus one while it is the latest_snapshot;
+    // the owner only overwrites the snapshot once this has dropped to zero
+    std::atomic<size_t> ref_count{0};
+    // atomic, since a thread that publishes its own snapshot compares it with the latest_snapshot
+    // without holding a reference, so the latter might get recycled concurrently
+    std::atomic<size_t> generation{0};
+    typename thread_control_block::protected_pointer_set pointers;
+    // only used by the thread that holds the entry while it searches the pool for an unused snapshot
+    protected_pointer_snapshot* next_rejected = nullptr;
+
+    bool is_unused() const
+    {
+      // (19) - this acquire-load synchronizes-with the release-fetch_sub (20)
+      return ref_count.load(std::memory_order_acquire) == 0;
+    }
+
+    void add_ref() { ref_count.fetch_add(1, std::memory_order_relaxed); }
+
+    void release_ref()
+    {
+      // (20) - this release-fetch_sub synchronizes-with the acquire-load (19)
+      //        and the acquire-fetch_add (21)
+      ref_count.fetch_sub(1, std::memory_order_release);
+    }
+  };
+
+  // The hazard pointers that protected some object at the time a batch of callbacks was retired.
+  // A thread that might still access a resource released by one of these callbacks must hold
+  // one of them, so the callbacks can be called once each of them has been changed or released
+  // at least once. In contrast to waiting until none of the recorded objects is protected
+  // anymore, this cannot be delayed indefinitely by a frequently protected node.
+  // Control blocks and hazard pointer blocks are never freed, so the recorded addresses stay valid.
+  template <typename Policy>
+  class hazard_pointer<Policy>::protected_slots
+  {
+  public:
+    bool empty() const { return slots.empty(); }
+
+    // Must be called after the callbacks have been retired.
+    void record()
+    {
+      slots.clear();
+
+      // (22) - this heavy fence enforces a total order with the light fence (4)
+      Policy::fence::heavy();
+
+      std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(),
+        [this](const auto& entry)
+        {
+          if (entry.is_active())
+            entry.for_each_protected_object([this](const hp_t& hp, detail::deletable_object* obj)
+            {
+              slots.push_back(slot{&hp, obj});
+            });
+        });
+    }
+
+    // Removes the hazard pointers that have changed since they were recorded and
+    // returns true once all of them have changed.
+    bool all_changed()
+    {
+      slots.erase(std::remove_if(slots.begin(), slots.end(), [](const slot& s)
+        {
+          detail::deletable_object* obj;
+          return !s.hp->try_get_object(obj) || obj != s.obj;
+        }), slots.end());
+
+      // (23) - this acquire-fence synchronizes-with the release-stores (5, 6)
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return slots.empty();
+    }
+
+  private:
+    using hp_t = typename thread_control_block::hazard_pointer;
+    struct slot
+    {
+      const hp_t* hp;
+      detail::deletable_object* obj;
+    };
+    std::vector<slot> slots;
+  };
+
+  // A chunk of retired nodes that have been abandoned by some thread when it terminated. The nodes are
+  // split into chunks so that each scan adopts at most a bounded number of them.
+  template <typename Policy>
+  struct hazard_pointer<Policy>::abandoned_nodes : detail::deletable_object_impl<abandoned_nodes>
+  {
+    explicit abandoned_nodes(detail::retire_list&& list, bool callbacks = false) :
+      list(std::move(list)),
+      callbacks(callbacks)
+    {}
+    detail::retire_list list;
+    // true if the list contains retired callbacks instead of nodes
+    bool callbacks;
   };
 
   template <typename Policy>
@@ -375,13 +685,16 @@ namespace emr {
 
     ~thread_data()
     {
-      if (retire_list != nullptr)
+      if (!retire_list.empty() || has_callbacks())
       {
         scan();
-        if (retire_list != nullptr)
-          global_thread_block_list.abandon_retired_nodes(retire_list);
+        abandon_retired_nodes();
       }
 
+      for (auto snapshot : own_snapshots)
+        if (snapshot != nullptr)
+          snapshot_pool.release_entry(snapshot);
+
       if (control_block != nullptr)
         global_thread_block_list.release_entry(control_block);
     }
@@ -399,81 +712,428 @@ namespace emr {
 
     std::size_t add_retired_node(detail::deletable_object* p)
     {
-      p->next = retire_list;
-      retire_list = p;
-      return ++number_of_retired_nodes;
+      retire_list.push(p);
+      budget_counter.retired();
+      return retire_list.size();
+    }
+
+    std::size_t add_retired_callback(detail::deletable_object* p)
+    {
+      pending_callbacks.push(p);
+      budget_counter.retired();
+      return pending_callbacks.size();
     }
 
     void scan()
     {
-      std::vector<const detail::deletable_object*> protected_pointers;
-      protected_pointers.reserve(Policy::number_of_active_hazard_pointers());
+      // A node's destructor can retire further nodes and thereby trigger another scan while
+      // we are still using protected_pointers. Such nodes simply remain in the retire_list
+      // and are handled by the next scan.
+      if (is_scanning)
+        return;
+
+      if (background_reclamation::is_enabled())
+      {
+        // the background thread performs the actual scan, so all we have to do is to hand over our retire_list
+        if (!retire_list.empty())
+          background_reclamation::submit(new retired_nodes_batch(retire_list.take_nodes()));
+        if (!pending_callbacks.empty())
+          background_reclamation::submit(new retired_callbacks_batch(pending_callbacks.take_nodes()));
+        return;
+      }
+      do_scan();
+    }
+
+    bool try_flush()
+    {
+      if (is_scanning)
+        return false; // called by the destructor of a node we are currently reclaiming
+
+      while (auto chunk = static_cast<abandoned_nodes*>(global_thread_block_list.try_adopt_abandoned_retired_node()))
+        adopt(chunk, retire_list);
+      do_scan();
+      return retire_list.empty() && !has_callbacks();
+    }
+
+    typename Policy::template retire_threshold<Policy> retire_threshold;
+
+  private:
+    void do_scan()
+    {
+      is_scanning = true;
+
+      auto adopted_nodes = adopt_abandoned_nodes();
+      auto snapshot = get_protected_pointers();
+
+      // the bags of the two lists are reused alternately
+      std::swap(retire_list, scanned_list);
+      auto scanned_nodes = scanned_list.size() + adopted_nodes.size();
+      // the destructors of the reclaimed nodes can retire new nodes, so the size of
+      // the retire_list does not tell us how many nodes could not be reclaimed
+      auto reclaimed_nodes = reclaim_nodes(scanned_list, snapshot->pointers);
+      reclaimed_nodes += reclaim_nodes(adopted_nodes, snapshot->pointers);
+      retire_threshold.update(scanned_nodes, reclaimed_nodes);
+      // a thread that has never used a hazard pointer does not have a control block
+      if (control_block != nullptr)
+        control_block->record_retire_threshold(retire_threshold.get());
+      snapshot->release_ref();
+      process_callbacks();
+      is_scanning = false;
+    }
+
+    bool has_callbacks() const
+    {
+      return !pending_callbacks.empty() || !waiting_callbacks.empty();
+    }
+
+    // The waiting callbacks were retired before the callback_slots were recorded, so all threads that
+    // might still access a resource released by one of them hold one of these hazard pointers. Once
+    // all of them have changed, the callbacks can be called and the pending callbacks take their place.
+    void process_callbacks()
+    {
+      if (!waiting_callbacks.empty() && !callback_slots.all_changed())
+        return;
+
+      auto ready = waiting_callbacks.take_nodes();
+      waiting_callbacks.splice(pending_callbacks);
+      if (!waiting_callbacks.empty())
+        callback_slots.record();
+      budget_counter.released(ready.size());
+      // callbacks retired by these callbacks end up in pending_callbacks
+      ready.delete_objects();
+    }
+
+    void ensure_has_control_block()
+    {
+      if (control_block == nullptr)
+      {
+        control_block = global_thread_block_list.acquire_entry();
+        control_block->initialize(hint);
+      }
+    }
+
+    // Splits the retire_list into chunks of at most max_abandoned_chunk_size nodes.
+    void abandon_retired_nodes()
+    {
+      detail::retire_list chunk;
+      retire_list.consume([&chunk](detail::deletable_object* p)
+      {
+        chunk.push(p);
+        if (chunk.size() == max_abandoned_chunk_size)
+          global_thread_block_list.abandon_retired_nodes(new abandoned_nodes(chunk.take_nodes()));
+      });
+      if (!chunk.empty())
+        global_thread_block_list.abandon_retired_nodes(new abandoned_nodes(chunk.take_nodes()));
+
+      pending_callbacks.splice(waiting_callbacks);
+      if (!pending_callbacks.empty())
+        global_thread_block_list.abandon_retired_nodes(new abandoned_nodes(pending_callbacks.take_nodes(), true));
+    }
+
+    // Adopts at most one chunk per scan, so the work of terminated threads gets distributed over
+    // several scans (and threads) and the latency of a single scan remains bounded.
+    detail::retire_list adopt_abandoned_nodes()
+    {
+      auto chunk = static_cast<abandoned_nodes*>(global_thread_block_list.try_adopt_abandoned_retired_node());
+      detail::retire_list result;
+      if (chunk != nullptr)
+        adopt(chunk, result);
+      return result;
+    }
+
+    // Adopted callbacks are treated like callbacks that have been retired by this thread.
+    void adopt(abandoned_nodes* chunk, detail::retire_list& nodes)
+    {
+      (chunk->callbacks ? pending_callbacks : nodes).splice(chunk->list);
+      delete chunk;
+    }
 
-      // (8) - this seq_cst-fence enforces a total order with the seq_cst-fence (4)
+    // Returns a snapshot that contains all pointers that were protected when the nodes in
+    // our retire_list and the adopted nodes were retired. The caller owns one reference.
+    protected_pointer_snapshot* get_protected_pointers()
+    {
+      // (16) - this seq_cst-fence enforces a total order with the seq_cst-fence (12)
       std::atomic_thread_fence(std::memory_order_seq_cst);
 
-      auto adopted_nodes = global_thread_block_list.adopt_abandoned_retired_nodes();
+      // A snapshot with a greater generation than the one we observe here was started
+      // after (16), i.e., after all our nodes have been retired, so we can simply reuse it.
+      auto generation = snapshot_generation.load(std::memory_order_relaxed);
+      auto latest = acquire_latest_snapshot();
+      if (latest != nullptr)
+      {
+        if (latest->generation.load(std::memory_order_relaxed) > generation)
+          return latest;
+        latest->release_ref();
+      }
+
+      auto snapshot = get_unused_snapshot();
+      snapshot->add_ref();
+      const auto own_generation = snapshot_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+      snapshot->generation.store(own_generation, std::memory_order_relaxed);
+      snapshot->pointers.clear(Policy::number_of_active_hazard_pointers());
+
+      // (12) - this heavy fence enforces a total order with the light fence (4) and the seq_cst-fence (16)
+      Policy::fence::heavy();
 
       std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(),
-        [&protected_pointers](const auto& entry)
+        [snapshot](const auto& entry)
         {
           if (entry.is_active())
-            entry.gather_protected_pointers(protected_pointers);
+            entry.gather_protected_pointers(snapshot->pointers);
         });
 
-      // (9) - this acquire-fence synchronizes-with the release-store (5)
+      // (13) - this acquire-fence synchronizes-with the release-stores (5, 6)
       std::atomic_thread_fence(std::memory_order_acquire);
 
-      std::sort(protected_pointers.begin(), protected_pointers.end());
-
-      auto list = retire_list;
-      retire_list = nullptr;
-      number_of_retired_nodes = 0;
-      reclaim_nodes(list, protected_pointers);
-      reclaim_nodes(adopted_nodes, protected_pointers);
+      // publish our snapshot unless some other thread has already published a newer one
+      snapshot->add_ref(); // the reference of latest_snapshot
+      latest = latest_snapshot.load(std::memory_order_relaxed);
+      do
+      {
+        if (latest != nullptr && latest->generation.load(std::memory_order_relaxed) >= own_generation)
+        {
+          snapshot->release_ref();
+          return snapshot;
+        }
+        // (17) - this release-CAS synchronizes-with the acquire-loads (18)
+      } while (!latest_snapshot.compare_exchange_weak(latest, snapshot,
+                                                      std::memory_order_release,
+                                                      std::memory_order_relaxed));
+      if (latest != nullptr)
+        latest->release_ref();
+      return snapshot;
     }
 
-  private:
-    void ensure_has_control_block()
+    // Returns the latest_snapshot with an additional reference, or nullptr if there is none yet.
+    static protected_pointer_snapshot* acquire_latest_snapshot()
     {
-      if (control_block == nullptr)
+      // (18) - these acquire-loads synchronize-with the release-CAS (17)
+      auto latest = latest_snapshot.load(std::memory_order_acquire);
+      while (latest != nullptr)
       {
-        control_block = global_thread_block_list.acquire_entry();
-        control_block->initialize(hint);
+        // (21) - this acquire-fetch_add synchronizes-with the release-fetch_sub (20)
+        latest->ref_count.fetch_add(1, std::memory_order_acquire);
+        // If it is still the latest_snapshot, it cannot be overwritten until we release our reference.
+        auto current = latest_snapshot.load(std::memory_order_acquire);
+        if (current == latest)
+          return latest;
+        latest->release_ref();
+        latest = current;
       }
+      return nullptr;
     }
 
-    void reclaim_nodes(detail::deletable_object* list,
-      const std::vector<const detail::deletable_object*>& protected_pointers)
+    // Our own snapshots are reused as long as nobody else uses them, so we usually do not
+    // have to allocate memory. We need two, since the last published one is often still the
+    // latest_snapshot. If both are in use, we exchange one of them for an unused one of the pool.
+    protected_pointer_snapshot* get_unused_snapshot()
     {
-      while (list != nullptr)
+      for (auto snapshot : own_snapshots)
+        if (snapshot != nullptr && snapshot->is_unused())
+          return snapshot;
+
+      auto& slot = own_snapshots[0] == nullptr ? own_snapshots[0] : own_snapshots[1];
+      auto busy = slot;
+      // the pool may hand out entries that are still used by other scans, so we keep them until we
+      // have found an unused one - otherwise we could get the same entry again and again
+      protected_pointer_snapshot* rejected = nullptr;
+      auto snapshot = snapshot_pool.acquire_entry();
+      while (!snapshot->is_unused())
+      {
+        snapshot->next_rejected = rejected;
+        rejected = snapshot;
+        snapshot = snapshot_pool.acquire_entry();
+      }
+      while (rejected != nullptr)
       {
-        auto cur = list;
-        list = list->next;
+        auto next = rejected->next_rejected;
+        snapshot_pool.release_entry(rejected);
+        rejected = next;
+      }
+      if (busy != nullptr)
+        snapshot_pool.release_entry(busy);
+      slot = snapshot;
+      return snapshot;
+    }
 
-        if (std::binary_search(protected_pointers.begin(), protected_pointers.end(), cur))
-          add_retired_node(cur);
+    // Returns the number of reclaimed nodes.
+    size_t reclaim_nodes(detail::retire_list& list,
+                         const typename thread_control_block::protected_pointer_set& protected_pointers)
+    {
+      size_t reclaimed_nodes = 0;
+      list.consume([this, &protected_pointers, &reclaimed_nodes](detail::deletable_object* p)
+      {
+        if (protected_pointers.contains(p))
+          retire_list.push(p);
         else
-          cur->delete_self();
-      }
+        {
+          budget_counter.released();
+          p->delete_self();
+          ++reclaimed_nodes;
+        }
+      });
+      return reclaimed_nodes;
     }
-    detail::deletable_object* retire_list = nullptr;
-    std::size_t number_of_retired_nodes = 0;
+
+    // The max. number of nodes in a chunk of abandoned nodes, i.e., the max. number
+    // of abandoned nodes that get adopted in a single scan.
+    static const std::size_t max_abandoned_chunk_size = 100;
+
+    detail::retire_list retire_list;
+    detail::retire_list scanned_list;
+    detail::retire_list pending_callbacks;
+    detail::retire_list waiting_callbacks;
+    protected_slots callback_slots;
     typename thread_control_block::hint hint;
 
+    protected_pointer_snapshot* own_snapshots[2] = {};
+    bool is_scanning = false;
+    typename memory_budget::thread_counter budget_counter;
+
     thread_control_block* control_block = nullptr;
 
     friend class hazard_pointer;
     ALLOCATION_COUNTER(hazard_pointer);
   };
 
-  template <size_t K, size_t A, size_t B, template <class> class ThreadControlBlock>
-  std::atomic<size_t> generic_hazard_pointer_policy<K ,A, B, ThreadControlBlock>::number_of_active_hps;
+  template <typename Policy>
+  void hazard_pointer<Policy>::synchronize()
+  {
+    while (!local_thread_data.try_flush())
+      std::this_thread::yield();
+  }
+
+  template <typename Policy>
+  bool hazard_pointer<Policy>::try_flush()
+  {
+    return local_thread_data.try_flush();
+  }
+
+  template <typename Policy>
+  struct hazard_pointer<Policy>::retired_nodes_batch : detail::reclamation_batch
+  {
+    explicit retired_nodes_batch(detail::retire_list&& list) : retire_list(std::move(list)) {}
+
+    bool try_reclaim() override
+    {
+      // batches are only processed by the background thread, so it can reuse the same set for all of them
+      static thread_local typename thread_control_block::protected_pointer_set protected_pointers;
+      gather_protected_pointers(protected_pointers);
+
+      auto list = retire_list.take_nodes();
+      std::ptrdiff_t reclaimed_nodes = 0;
+      list.consume([this, &reclaimed_nodes](detail::deletable_object* p)
+      {
+        if (protected_pointers.contains(p))
+          retire_list.push(p);
+        else
+        {
+          ++reclaimed_nodes;
+          p->delete_self();
+        }
+      });
+      memory_budget::add(-reclaimed_nodes);
+      return retire_list.empty();
+    }
+
+  private:
+    detail::retire_list retire_list;
+  };
+
+  // The hazard pointers that protect some object when the batch is processed for the first time are
+  // recorded; the callbacks are called once all of them have changed (see protected_slots).
+  template <typename Policy>
+  struct hazard_pointer<Policy>::retired_callbacks_batch : detail::reclamation_batch
+  {
+    explicit retired_callbacks_batch(detail::retire_list&& list) : callbacks(std::move(list)) {}
+
+    bool try_reclaim() override
+    {
+      if (!has_initial_slots)
+      {
+        initial_slots.record();
+        has_initial_slots = true;
+      }
+      if (!initial_slots.all_changed())
+        return false;
+
+      memory_budget::add(-static_cast<std::ptrdiff_t>(callbacks.size()));
+      callbacks.delete_objects();
+      return true;
+    }
+
+  private:
+    protected_slots initial_slots;
+    detail::retire_list callbacks;
+    bool has_initial_slots = false;
+  };
+
+  template <typename Policy>
+  void hazard_pointer<Policy>::gather_protected_pointers(typename thread_control_block::protected_pointer_set& pointers)
+  {
+    pointers.clear(Policy::number_of_active_hazard_pointers());
+
+    // (14) - this heavy fence enforces a total order with the light fence (4)
+    Policy::fence::heavy();
+
+    std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(),
+      [&pointers](const auto& entry)
+      {
+        if (entry.is_active())
+          entry.gather_protected_pointers(pointers);
+      });
+
+    // (15) - this acquire-fence synchronizes-with the release-stores (5, 6)
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+
+  template <size_t K, size_t A, size_t B, template <class> class ThreadControlBlock, bool AsymmetricFence>
+  std::atomic<size_t> generic_hazard_pointer_policy<K ,A, B, ThreadControlBlock, AsymmetricFence>::number_of_active_hps;
+
+  template <class Policy>
+  void adaptive_retire_threshold<Policy>::update(size_t scanned_nodes, size_t reclaimed_nodes)
+  {
+    if (reclaimed_nodes * 2 < scanned_nodes)
+      threshold *= 2; // less than half of the nodes could be reclaimed
+    else if (reclaimed_nodes * 4 > scanned_nodes * 3)
+      threshold -= threshold / 4; // more than three quarters of the nodes could be reclaimed
+
+    const size_t lower_bound = Policy::number_of_active_hazard_pointers() + Policy::min_retired_nodes;
+    const size_t upper_bound = std::max(lower_bound, static_cast<size_t>(Policy::max_retired_nodes));
+    threshold = std::min(std::max(threshold, lower_bound), upper_bound);
+  }
+
+  template <typename Policy>
+  auto hazard_pointer<Policy>::get_retire_threshold_statistics() -> retire_threshold_statistics
+  {
+    retire_threshold_statistics result;
+    size_t sum_of_thresholds = 0;
+    std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(),
+      [&](const auto& block)
+      {
+        result.updates += block.threshold_updates.load(std::memory_order_relaxed);
+        sum_of_thresholds += block.sum_of_thresholds.load(std::memory_order_relaxed);
+        result.max_threshold = std::max(result.max_threshold, block.max_threshold.load(std::memory_order_relaxed));
+      });
+    if (result.updates > 0)
+      result.avg_threshold = sum_of_thresholds / static_cast<double>(result.updates);
+    return result;
+  }
 
   template <typename Policy>
   detail::thread_block_list<typename hazard_pointer<Policy>::thread_control_block>
     hazard_pointer<Policy>::global_thread_block_list;
 
+  template <typename Policy>
+  std::atomic<typename hazard_pointer<Policy>::protected_pointer_snapshot*> hazard_pointer<Policy>::latest_snapshot;
+
+  template <typename Policy>
+  detail::thread_block_list<typename hazard_pointer<Policy>::protected_pointer_snapshot>
+    hazard_pointer<Policy>::snapshot_pool;
+
+  template <typename Policy>
+  std::atomic<size_t> hazard_pointer<Policy>::snapshot_generation;
+
   template <typename Policy>
   thread_local typename hazard_pointer<Policy>::thread_data hazard_pointer<Policy>::local_thread_data;
 
@@ -2,43 +2,111 @@
 
 #include <emr/detail/concurrent_ptr.hpp>
 #include <emr/detail/guard_ptr.hpp>
+#include <emr/detail/deletable_object.hpp>
+#include <emr/detail/thread_block_list.hpp>
 #include <emr/detail/allocation_tracker.hpp>
 
 #include <emr/acquire_guard.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace emr {
 
-  template <bool InsertPadding = false, size_t ThreadLocalFreeListSize = 0>
+  // Freed nodes are kept in free lists and reused for new allocations of the same type.
+  // If ThreadLocalFreeListSize > 0 each thread caches up to this number of nodes. If additionally
+  // DepotShards > 0, the thread caches work like magazines: every thread holds a loaded and a
+  // spare magazine of ThreadLocalFreeListSize nodes each and exchanges full magazines with a depot
+  // that is split into DepotShards stacks, so the threads do not contend on a single global stack.
+  // The depot keeps whole magazines, so a thread pushes or pops a magazine with a single CAS.
+  // If FreeListWatermark > 0, free nodes that would exceed this number of nodes in the shared free
+  // lists (global stack or depot) are returned to the allocator instead. Since other threads might
+  // still increment the ref_count of a free node in guard_ptr::acquire, the nodes are only released
+  // once every thread that held a guard_ptr at that time has released all its guards; until then
+  // they are kept in a per-thread list. This requires every thread to announce when it starts and
+  // stops holding guards, which adds a fence to guard_ptr::acquire.
+  // If SplitRefCount is true, every concurrent_ptr keeps an external count in the upper 16 bits of
+  // the pointer (64-bit only). guard_ptr::acquire increments this count instead of the ref_count of
+  // the target, which has been incremented by a whole batch of references in advance when the
+  // pointer was stored. So readers of a popular node only touch the concurrent_ptr they read from,
+  // and the node's ref_count is only updated once per batch (and when a reference is released).
+  // A concurrent_ptr does not own its target, though: the unused part of the batch is returned once
+  // the pointer gets changed or destroyed. But since the target's ref_count includes this part,
+  // removed nodes keep their successors alive until they are destroyed themselves.
+  // The target of a pointer that is stored must be protected (by a guard_ptr or by ownership).
+  template <bool InsertPadding = false, size_t ThreadLocalFreeListSize = 0, size_t DepotShards = 0,
+            size_t FreeListWatermark = 0, bool SplitRefCount = false>
   class lock_free_ref_count
   {
+    static_assert(DepotShards == 0 || ThreadLocalFreeListSize > 0,
+                  "the depot requires thread local free lists (magazines)");
+    static_assert(!SplitRefCount || sizeof(uintptr_t) == 8,
+                  "split reference counts require the upper bits of 64-bit pointers");
+
     template <class T, class MarkedPtr>
     class guard_ptr;
 
+    template <class T, std::size_t N = T::number_of_mark_bits>
+    class split_concurrent_ptr;
+
+    template <class T, std::size_t N = T::number_of_mark_bits>
+    using plain_concurrent_ptr = emr::detail::concurrent_ptr<T, N, guard_ptr>;
+
   public:
     template <class T, std::size_t N = T::number_of_mark_bits>
-    using concurrent_ptr = emr::detail::concurrent_ptr<T, N, guard_ptr>;
+    using concurrent_ptr = std::conditional_t<SplitRefCount, split_concurrent_ptr<T, N>, plain_concurrent_ptr<T, N>>;
 
     template <class T, std::size_t N = 0, class DeleterT = std::default_delete<T>>
     class enable_concurrent_ptr;
 
     class region_guard {};
 
+    // Objects are destroyed as soon as their last reference is released, so there are never
+    // any retired objects waiting to be reclaimed.
+    static void synchronize() {}
+    static bool try_flush() { return true; }
+
+    // The number of free nodes that have been returned to the allocator (see FreeListWatermark).
+    static std::size_t number_of_trimmed_nodes() { return trimmed_nodes.load(std::memory_order_relaxed); }
+
+    // In contrast to the other reclaimers there is no retire(f): references to a node do not
+    // protect the resources that are only reachable through it, so there is no point in time at
+    // which f could safely be called. Such resources must be owned by the (reference counted)
+    // node itself and be released by its destructor.
+
     ALLOCATION_TRACKER
   private:
     static constexpr unsigned RefCountInc = 2;
     static constexpr unsigned RefCountClaimBit = 1;
 
+    static constexpr bool trim_free_lists = FreeListWatermark > 0;
+    struct guard_counter;
+    class thread_guards;
+    class grace_period;
+    static detail::thread_block_list<guard_counter> guard_counters;
+    static std::atomic<std::size_t> trimmed_nodes;
+    static thread_guards& local_guards();
+    // announce that the current thread starts/stops holding a guard (only if trim_free_lists)
+    static void add_guard();
+    static void remove_guard();
+
+    // Releases the given number of references to p and frees it if this was the last one.
+    template <class T>
+    static void release_references(T* p, unsigned refs = 1) noexcept;
+
     ALLOCATION_TRACKING_FUNCTIONS;
 #ifdef TRACK_ALLOCATIONS
     static emr::detail::allocation_counter& allocation_counter();
 #endif
   };
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, std::size_t N, class DeleterT>
-  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::enable_concurrent_ptr:
+  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::enable_concurrent_ptr:
     private detail::tracked_object<lock_free_ref_count>
   {
   protected:
@@ -67,7 +135,7 @@ namespace emr {
     void operator delete(void* p);
 
   private:
-    bool decrement_refcnt();
+    bool decrement_refcnt(unsigned refs = 1);
     bool is_destroyed() const { return getHeader()->destroyed.load(std::memory_order_relaxed); }
     void push_to_free_list() { global_free_list.push(static_cast<T*>(this)); }
 
@@ -75,29 +143,41 @@ namespace emr {
       std::atomic<unsigned> ref_count;
       std::atomic<bool> destroyed;
     };
-    struct padded_header : unpadded_header {
-      char padding[64 - sizeof(unpadded_header)];
+    // in magazine mode the first node of every magazine in the depot knows the last node and
+    // the size of its magazine, so a magazine can be taken from the depot as a whole
+    struct magazine_header : unpadded_header {
+      T* magazine_last;
+      std::size_t magazine_size;
+    };
+    using basic_header = std::conditional_t<(DepotShards > 0), magazine_header, unpadded_header>;
+    struct padded_header : basic_header {
+      char padding[64 - sizeof(basic_header)];
     };
-    using header = std::conditional_t<InsertPadding, padded_header, unpadded_header>;
+    using header = std::conditional_t<InsertPadding, padded_header, basic_header>;
     header* getHeader() { return static_cast<header*>(static_cast<void*>(this)) - 1; }
     const header* getHeader() const { return static_cast<const header*>(static_cast<const void*>(this)) - 1; }
+    // only available in magazine mode (nullptr otherwise)
+    magazine_header* getMagazineHeader() { return magazine_header_of(getHeader()); }
+    static magazine_header* magazine_header_of(magazine_header* h) { return h; }
+    static magazine_header* magazine_header_of(void*) { return nullptr; }
 
     std::atomic<unsigned>& ref_count() { return getHeader()->ref_count; }
     std::atomic<bool>& destroyed() { return getHeader()->destroyed; }
-    concurrent_ptr<T, N> next_free;
+    plain_concurrent_ptr<T, N> next_free;
 
     friend class lock_free_ref_count;
 
-    using guard_ptr = typename concurrent_ptr<T, N>::guard_ptr;
-    using marked_ptr = typename concurrent_ptr<T, N>::marked_ptr;
+    using guard_ptr = typename plain_concurrent_ptr<T, N>::guard_ptr;
+    using marked_ptr = typename plain_concurrent_ptr<T, N>::marked_ptr;
 
     class free_list;
     static free_list global_free_list;
   };
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::guard_ptr :
+  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::guard_ptr :
       public detail::guard_ptr<T, MarkedPtr, guard_ptr<T, MarkedPtr>>
   {
     using base = detail::guard_ptr<T, MarkedPtr, guard_ptr>;
@@ -127,6 +207,113 @@ namespace emr {
 
     // Reset. Deleter d will be applied some time after all owners release their ownership.
     void reclaim(Deleter d = Deleter()) noexcept;
+
+  private:
+    template <class ConcurrentPtr>
+    void increment_and_validate(ConcurrentPtr& p, std::memory_order order) noexcept;
+
+    void do_acquire(plain_concurrent_ptr<T>& p, std::memory_order order) noexcept;
+    void do_acquire(split_concurrent_ptr<T>& p, std::memory_order order) noexcept;
+    bool do_acquire_if_equal(plain_concurrent_ptr<T>& p, const MarkedPtr& expected, std::memory_order order) noexcept;
+    bool do_acquire_if_equal(split_concurrent_ptr<T>& p, const MarkedPtr& expected, std::memory_order order) noexcept;
+  };
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr
+  {
+  public:
+    using marked_ptr = emr::detail::marked_ptr<T, N>;
+    using guard_ptr = typename plain_concurrent_ptr<T, N>::guard_ptr;
+
+    split_concurrent_ptr(const marked_ptr& p = marked_ptr()) noexcept;
+    split_concurrent_ptr(const split_concurrent_ptr&) = delete;
+    split_concurrent_ptr(split_concurrent_ptr&&) = delete;
+    split_concurrent_ptr& operator=(const split_concurrent_ptr&) = delete;
+    split_concurrent_ptr& operator=(split_concurrent_ptr&&) = delete;
+    ~split_concurrent_ptr();
+
+    // Atomic load that does not guard target from being reclaimed.
+    marked_ptr load(std::memory_order order = std::memory_order_seq_cst) const
+    {
+      return to_marked_ptr(word.load(order));
+    }
+
+    // Atomic store.
+    void store(const marked_ptr& src, std::memory_order order = std::memory_order_seq_cst);
+
+    // Shorthand for store (src.get())
+    void store(const guard_ptr& src, std::memory_order order = std::memory_order_seq_cst)
+    {
+      store(marked_ptr(src.get()), order);
+    }
+
+    // A concurrent change of the external count alone does not let these operations fail.
+    bool compare_exchange_weak(marked_ptr& expected, marked_ptr desired, std::memory_order order = std::memory_order_seq_cst)
+    {
+      return compare_exchange(expected, desired, order, failure_order(order));
+    }
+
+    bool compare_exchange_weak(marked_ptr& expected, marked_ptr desired, std::memory_order success, std::memory_order failure)
+    {
+      return compare_exchange(expected, desired, success, failure);
+    }
+
+    bool compare_exchange_strong(marked_ptr& expected, marked_ptr desired, std::memory_order order = std::memory_order_seq_cst)
+    {
+      return compare_exchange(expected, desired, order, failure_order(order));
+    }
+
+    bool compare_exchange_strong(marked_ptr& expected, marked_ptr desired, std::memory_order success, std::memory_order failure)
+    {
+      return compare_exchange(expected, desired, success, failure);
+    }
+
+  private:
+    friend class lock_free_ref_count;
+
+    // the number of references a concurrent_ptr hands out before the batch has to be replaced
+    static constexpr uintptr_t batch_size = 1 << 14;
+    static constexpr unsigned CountShift = 48;
+    static constexpr uintptr_t CountInc = static_cast<uintptr_t>(1) << CountShift;
+    static constexpr uintptr_t CountMask = ~(CountInc - 1);
+    static constexpr uintptr_t MarkMask = (static_cast<uintptr_t>(1) << N) - 1;
+
+    static marked_ptr to_marked_ptr(uintptr_t w)
+    {
+      return marked_ptr(reinterpret_cast<T*>(w & ~(CountMask | MarkMask)), w & MarkMask);
+    }
+    static uintptr_t to_word(const marked_ptr& p)
+    {
+      return reinterpret_cast<uintptr_t>(p.get()) | p.mark();
+    }
+    static uintptr_t count(uintptr_t w) { return w >> CountShift; }
+    static std::memory_order failure_order(std::memory_order order)
+    {
+      return order == std::memory_order_acq_rel ? std::memory_order_acquire :
+             order == std::memory_order_release ? std::memory_order_relaxed : order;
+    }
+    // a new target has to be published with (at least) release order, see add_batch
+    static std::memory_order with_release(std::memory_order order)
+    {
+      return order == std::memory_order_relaxed ? std::memory_order_release :
+             order == std::memory_order_acquire || order == std::memory_order_consume ? std::memory_order_acq_rel : order;
+    }
+
+    // The batch has to be added before the pointer is published, so that a reader's release of a
+    // reference from the batch cannot precede it in the modification order of the ref_count.
+    static void add_batch(T* p);
+    static void release_batch(uintptr_t w);
+
+    bool compare_exchange(marked_ptr& expected, marked_ptr desired, std::memory_order success, std::memory_order failure);
+
+    // Takes a reference from the current batch; returns false if the batch is already exhausted.
+    bool acquire_reference(marked_ptr& result, std::memory_order order);
+    void replace_exhausted_batch(T* p);
+
+    std::atomic<uintptr_t> word;
   };
 }
 
@@ -2,11 +2,105 @@
 #error "This is an impl file and must not be included directly!"
 #endif
 
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace emr {
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  struct lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::guard_counter :
+    detail::thread_block_list<guard_counter>::entry
+  {
+    // incremented whenever the thread starts or stops holding guards, i.e., odd while it holds some
+    std::atomic<unsigned> value{0};
+  };
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::thread_guards
+  {
+  public:
+    ~thread_guards()
+    {
+      if (counter != nullptr)
+        guard_counters.release_entry(counter);
+    }
+
+    void add()
+    {
+      if (active_guards++ > 0)
+        return;
+
+      if (counter == nullptr)
+        counter = guard_counters.acquire_entry();
+      counter->value.store(counter->value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      // (10) - this seq_cst-fence enforces a total order with the seq_cst-fence (12)
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void remove()
+    {
+      assert(active_guards > 0);
+      if (--active_guards > 0)
+        return;
+
+      // (11) - this release-store synchronizes-with the acquire-loads (13, 14)
+      counter->value.store(counter->value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+  private:
+    guard_counter* counter = nullptr;
+    unsigned active_guards = 0;
+  };
+
+  // A free node can only be reached by a thread that already holds a guard (e.g., to a removed node
+  // that still points to it). So once every thread that held guards when the grace period started
+  // has released all of them, no thread can increment the ref_count of the node any more.
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::grace_period
+  {
+  public:
+    void start()
+    {
+      // (12) - this seq_cst-fence enforces a total order with the seq_cst-fence (10)
+      // A thread that announces its guards after this fence observes that the nodes are no longer
+      // reachable; otherwise we see its announcement below.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      active_threads.clear();
+      for (auto& counter : guard_counters)
+      {
+        // (13) - this acquire-load synchronizes-with the release-store (11)
+        auto value = counter.value.load(std::memory_order_acquire);
+        if (value & 1)
+          active_threads.emplace_back(&counter, value);
+      }
+    }
+
+    bool has_expired()
+    {
+      while (!active_threads.empty())
+      {
+        auto& thread = active_threads.back();
+        // (14) - this acquire-load synchronizes-with the release-store (11)
+        if (thread.first->value.load(std::memory_order_acquire) == thread.second)
+          return false;
+        active_threads.pop_back();
+      }
+      return true;
+    }
+
+  private:
+    std::vector<std::pair<guard_counter*, unsigned>> active_threads;
+  };
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, std::size_t N, class Deleter>
-  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::enable_concurrent_ptr<T, N, Deleter>::free_list
+  class lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::enable_concurrent_ptr<T, N, Deleter>::free_list
   {
   public:
     T* pop()
@@ -15,12 +109,16 @@ namespace emr {
         if (auto result = local_free_list().pop())
           return result;
 
+      // in magazine mode all free nodes are either in the thread caches or in the depot
+      if (depot_shards > 0)
+        return nullptr;
+
       guard_ptr guard;
 
       while (true)
       {
         // (1) - this acquire-load synchronizes-with the release-CAS (3)
-        guard = acquire_guard(head, std::memory_order_acquire);
+        guard.do_acquire(head, std::memory_order_acquire);
         if (guard.get() == nullptr)
           return nullptr;
 
@@ -41,6 +139,8 @@ namespace emr {
           ptr->ref_count().fetch_sub(RefCountClaimBit, std::memory_order_relaxed); // clear claim bit
           ptr->next_free.store(nullptr, std::memory_order_relaxed);
           guard.ptr.reset(); // reset guard_ptr to prevent decrement of ref_count
+          remove_guard();
+          count_free_nodes(-1);
           return ptr;
         }
       }
@@ -53,12 +153,39 @@ namespace emr {
       if (max_local_elements > 0 && local_free_list().push(node))
         return;
 
-      add_nodes(node, node);
+      if (exceeds_watermark())
+        local_trimmed_nodes().add(node, node, 1);
+      else
+        add_nodes(node, node, 1);
     }
 
   private:
-    void add_nodes(T* first, T* last)
+    // puts the chain starting with first back on the global stack (or into the given depot shard,
+    // split into magazines of at most max_local_elements nodes)
+    void add_chain(T* first, unsigned shard)
     {
+      while (first != nullptr)
+      {
+        auto last = first;
+        size_t count = 1;
+        auto next = last->next_free.load(std::memory_order_relaxed).get();
+        while (next != nullptr && (depot_shards == 0 || count < max_local_elements))
+        {
+          last = next;
+          ++count;
+          next = last->next_free.load(std::memory_order_relaxed).get();
+        }
+        if (depot_shards > 0)
+          add_to_depot(first, last, shard, count);
+        else
+          add_nodes(first, last, count);
+        first = next;
+      }
+    }
+
+    void add_nodes(T* first, T* last, size_t count)
+    {
+      count_free_nodes(static_cast<std::ptrdiff_t>(count));
       // (2) - this acquire-load synchronizes-with the release-CAS (3)
       auto old = head.load(std::memory_order_acquire);
       do {
@@ -68,40 +195,169 @@ namespace emr {
       } while (!head.compare_exchange_weak(old, first, std::memory_order_release, std::memory_order_acquire));
     }
 
+    // pushes the magazine first..last (which must not be longer than max_local_elements) on the given depot shard
+    void add_to_depot(T* first, T* last, unsigned shard, size_t count)
+    {
+      assert(count > 0 && count <= max_local_elements);
+      count_free_nodes(static_cast<std::ptrdiff_t>(count));
+      first->getMagazineHeader()->magazine_last = last;
+      first->getMagazineHeader()->magazine_size = count;
+      auto& depot_head = depot[shard].head;
+      auto old = depot_head.load(std::memory_order_relaxed);
+      do {
+        // the last node of a magazine links to the first node of the next one
+        last->next_free.store(old, std::memory_order_relaxed);
+        // (8) - this release-CAS synchronizes-with the acquire-load (9)
+      } while (!depot_head.compare_exchange_weak(old, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Takes one magazine from the depot, starting with the given shard. Like pop, this returns the
+    // first node of the magazine as allocated node, and stores the remaining nodes in first/last/count.
+    T* take_from_depot(unsigned shard, T*& first, T*& last, size_t& count)
+    {
+      for (unsigned i = 0; i < depot_shards; ++i)
+      {
+        auto& depot_head = depot[(shard + i) % depot_shards].head;
+        if (depot_head.load(std::memory_order_relaxed) == nullptr)
+          continue;
+
+        // Like in pop, the reference held by the guard prevents the magazine's first node from
+        // being put back on some free list before we are done, so we cannot suffer from ABA.
+        // The first node of a magazine is always handed out as allocated node for this reason.
+        guard_ptr guard;
+        while (true)
+        {
+          // (9) - this acquire-load synchronizes-with the release-CAS (8)
+          guard.do_acquire(depot_head, std::memory_order_acquire);
+          auto magazine = guard.get();
+          if (magazine == nullptr)
+            break;
+
+          auto magazine_last = magazine->getMagazineHeader()->magazine_last;
+          auto magazine_size = magazine->getMagazineHeader()->magazine_size;
+          marked_ptr expected(guard);
+          // since the depot head is only changed via CAS operations it is sufficient to use relaxed
+          // order for this operation as it is always part of a release-sequence headed by (8)
+          if (depot_head.compare_exchange_weak(
+            expected,
+            magazine_last->next_free.load(std::memory_order_relaxed),
+            std::memory_order_relaxed))
+          {
+            assert((magazine->ref_count().load(std::memory_order_relaxed) & RefCountClaimBit) != 0 &&
+              "ClaimBit must be set for a node in the depot");
+
+            count_free_nodes(-static_cast<std::ptrdiff_t>(magazine_size));
+            count = magazine_size - 1;
+            first = count > 0 ? magazine->next_free.load(std::memory_order_relaxed).get() : nullptr;
+            last = count > 0 ? magazine_last : nullptr;
+            magazine_last->next_free.store(nullptr, std::memory_order_relaxed);
+
+            magazine->ref_count().fetch_sub(RefCountClaimBit, std::memory_order_relaxed); // clear claim bit
+            magazine->next_free.store(nullptr, std::memory_order_relaxed);
+            guard.ptr.reset(); // reset guard_ptr to prevent decrement of ref_count
+            remove_guard();
+            return magazine;
+          }
+        }
+      }
+      return nullptr;
+    }
+
     // the free list is implemented as a FILO single linked list
     // the LSB of a node's ref_count acts as claim bit, so for all nodes on the free list the bit has to be set
     concurrent_ptr<T, N> head;
 
+    // the approximate number of nodes on the global stack and in the depot (only if trim_free_lists)
+    std::atomic<std::ptrdiff_t> free_nodes;
+
+    void count_free_nodes(std::ptrdiff_t n)
+    {
+      if (trim_free_lists)
+        free_nodes.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    bool exceeds_watermark() const
+    {
+      return trim_free_lists &&
+        free_nodes.load(std::memory_order_relaxed) >= static_cast<std::ptrdiff_t>(FreeListWatermark);
+    }
+
+    // every shard is a stack of magazines
+    struct alignas(64) depot_shard
+    {
+      concurrent_ptr<T, N> head;
+    };
+    static constexpr size_t depot_shards = DepotShards;
+    depot_shard depot[depot_shards > 0 ? depot_shards : 1];
+    std::atomic<unsigned> next_depot_shard;
+
     class thread_local_free_list
     {
     public:
+      thread_local_free_list() :
+        shard(depot_shards > 0
+                ? global_free_list.next_depot_shard.fetch_add(1, std::memory_order_relaxed) % depot_shards
+                : 0)
+      {}
+
       ~thread_local_free_list() noexcept
       {
-          if (head == nullptr)
-            return;
-          auto first = head;
-          auto last = head;
-          auto next = last->next_free.load(std::memory_order_relaxed);
-          while (next)
-          {
-            last = next.get();
-            next = next->next_free.load(std::memory_order_relaxed);
-          }
-          global_free_list.add_nodes(first, last);
+        if (depot_shards == 0)
+          global_free_list.add_chain(head, shard);
+        else
+        {
+          if (spare != nullptr)
+            global_free_list.add_to_depot(spare, spare_last, shard, max_local_elements);
+          if (head != nullptr)
+            global_free_list.add_to_depot(head, last, shard, number_of_elements);
+        }
       }
 
       bool push(T* node)
       {
         if (number_of_elements >= max_local_elements)
-          return false;
+        {
+          if (depot_shards == 0)
+            return false;
+
+          // the loaded magazine is full -> it becomes the new spare and a full spare goes to the depot
+          if (spare != nullptr)
+          {
+            if (global_free_list.exceeds_watermark())
+              local_trimmed_nodes().add(spare, spare_last, max_local_elements);
+            else
+              global_free_list.add_to_depot(spare, spare_last, shard, max_local_elements);
+          }
+          spare = head;
+          spare_last = last;
+          head = nullptr;
+          number_of_elements = 0;
+        }
+        if (head == nullptr)
+          last = node;
         node->next_free.store(head, std::memory_order_relaxed);
         head = node;
         ++number_of_elements;
         return true;
       }
 
+      unsigned depot_shard() const { return shard; }
+
       T* pop()
       {
+        if (head == nullptr && depot_shards > 0)
+        {
+          if (spare == nullptr)
+          {
+            // the remaining nodes of the magazine become the loaded magazine
+            return global_free_list.take_from_depot(shard, head, last, number_of_elements);
+          }
+          head = spare;
+          last = spare_last;
+          number_of_elements = max_local_elements;
+          spare = nullptr;
+        }
+
         auto result = head;
         if (result)
         {
@@ -115,8 +371,14 @@ namespace emr {
         return result;
       }
     private:
+      // the depot shard this thread returns its full magazines to
+      const unsigned shard;
       size_t number_of_elements = 0;
       T* head = nullptr;
+      T* last = nullptr;
+      // only used in magazine mode (depot_shards > 0), always full
+      T* spare = nullptr;
+      T* spare_last = nullptr;
     };
 
     static constexpr size_t max_local_elements = ThreadLocalFreeListSize;
@@ -127,11 +389,106 @@ namespace emr {
       alignas(64) static thread_local thread_local_free_list local_free_list;
       return local_free_list;
     }
+
+    // The free nodes beyond the watermark that have been freed by this thread. They are collected
+    // in batches and returned to the allocator once the grace period of a batch has expired.
+    class trimmed_node_list
+    {
+    public:
+      // this also ensures that the thread's free list is destroyed after this list
+      trimmed_node_list() :
+        shard(local_free_list().depot_shard())
+      {}
+
+      ~trimmed_node_list()
+      {
+        // We do not wait for threads that still hold guards - nodes that
+        // cannot be released yet are put back on the free list instead.
+        if (pending != nullptr && pending_grace_period.has_expired())
+          release_nodes(pending);
+        if (pending == nullptr && collected != nullptr)
+        {
+          pending_grace_period.start();
+          if (pending_grace_period.has_expired())
+            release_nodes(collected);
+        }
+        global_free_list.add_chain(pending, shard);
+        global_free_list.add_chain(collected, shard);
+      }
+
+      void add(T* first, T* last, size_t count)
+      {
+        last->next_free.store(collected, std::memory_order_relaxed);
+        collected = first;
+        number_of_collected += count;
+        if (number_of_collected >= batch_size)
+          try_release();
+      }
+
+    private:
+      // Releases the pending batch if its grace period has expired and starts a new one for the
+      // collected nodes; otherwise we continue to collect.
+      void try_release()
+      {
+        if (pending != nullptr)
+        {
+          if (!pending_grace_period.has_expired())
+          {
+            // Some thread holds its guards for a long time. The collected nodes cannot be
+            // reused in the meantime, so we must not hold back an unbounded number of them.
+            if (number_of_collected >= max_collected)
+            {
+              global_free_list.add_chain(collected, shard);
+              collected = nullptr;
+              number_of_collected = 0;
+            }
+            return;
+          }
+          release_nodes(pending);
+        }
+        pending = collected;
+        collected = nullptr;
+        number_of_collected = 0;
+        pending_grace_period.start();
+      }
+
+      static void release_nodes(T*& first)
+      {
+        size_t count = 0;
+        while (first != nullptr)
+        {
+          auto next = first->next_free.load(std::memory_order_relaxed).get();
+          assert(first->ref_count().load(std::memory_order_relaxed) == RefCountClaimBit &&
+                 "a node must not be released while other threads can still reference it");
+          ::operator delete(first->getHeader());
+          first = next;
+          ++count;
+        }
+        trimmed_nodes.fetch_add(count, std::memory_order_relaxed);
+      }
+
+      static constexpr size_t batch_size = 64;
+      static constexpr size_t max_collected = 4 * batch_size;
+
+      // the depot shard of this thread that surplus nodes are handed back to
+      const unsigned shard;
+      T* collected = nullptr;
+      size_t number_of_collected = 0;
+      T* pending = nullptr;
+      grace_period pending_grace_period;
+    };
+
+    static trimmed_node_list& local_trimmed_nodes()
+    {
+      static thread_local trimmed_node_list list;
+      return list;
+    }
   };
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, std::size_t N, class Deleter>
-  void* lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  void* lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     enable_concurrent_ptr<T, N, Deleter>::operator new(size_t sz)
   {
     assert(sz == sizeof(T) && "Cannot handle allocations of anything other than T instances");
@@ -146,9 +503,10 @@ namespace emr {
     return result;
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, std::size_t N, class Deleter>
-  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     enable_concurrent_ptr<T, N, Deleter>::operator delete(void* p)
   {
     auto node = static_cast<T*>(p);
@@ -158,15 +516,16 @@ namespace emr {
       node->push_to_free_list();
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, std::size_t N, class Deleter>
-  bool lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
-    enable_concurrent_ptr<T, N, Deleter>::decrement_refcnt()
+  bool lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    enable_concurrent_ptr<T, N, Deleter>::decrement_refcnt(unsigned refs)
   {
     unsigned old_refcnt, new_refcnt;
     do {
       old_refcnt = ref_count().load(std::memory_order_relaxed);
-      new_refcnt = old_refcnt - RefCountInc;
+      new_refcnt = old_refcnt - refs * RefCountInc;
       if (new_refcnt == 0)
         new_refcnt = RefCountClaimBit;
       // (4) - this release/acquire CAS synchronizes with itself
@@ -180,35 +539,42 @@ namespace emr {
     return (old_refcnt - new_refcnt) & RefCountClaimBit;
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     guard_ptr<T, MarkedPtr>::guard_ptr(const MarkedPtr& p) noexcept :
       base(p)
   {
     if (this->ptr.get() != nullptr)
+    {
       this->ptr->ref_count().fetch_add(RefCountInc, std::memory_order_relaxed);
+      add_guard();
+    }
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     guard_ptr<T, MarkedPtr>::guard_ptr(const guard_ptr& p) noexcept :
       guard_ptr(p.ptr)
   {}
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     guard_ptr<T, MarkedPtr>::guard_ptr(guard_ptr&& p) noexcept :
       base(p.ptr)
   {
     p.ptr.reset();
   }
   
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  auto lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  auto lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     guard_ptr<T, MarkedPtr>::operator=(const guard_ptr& p)
       -> guard_ptr&
   {
@@ -218,13 +584,17 @@ namespace emr {
     reset();
     this->ptr = p.ptr;
     if (this->ptr.get() != nullptr)
+    {
       this->ptr->ref_count().fetch_add(RefCountInc, std::memory_order_relaxed);
+      add_guard();
+    }
     return *this;
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  auto lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  auto lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     guard_ptr<T, MarkedPtr>::operator=(guard_ptr&& p)
       -> guard_ptr&
   {
@@ -237,18 +607,44 @@ namespace emr {
     return *this;
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     guard_ptr<T, MarkedPtr>::acquire(concurrent_ptr<T>& p, std::memory_order order) noexcept
   {
+    do_acquire(p, order);
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, class MarkedPtr>
+  bool lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    guard_ptr<T, MarkedPtr>::acquire_if_equal(
+      concurrent_ptr<T>& p, const MarkedPtr& expected, std::memory_order order) noexcept
+  {
+    return do_acquire_if_equal(p, expected, order);
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, class MarkedPtr>
+  template <class ConcurrentPtr>
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    guard_ptr<T, MarkedPtr>::increment_and_validate(ConcurrentPtr& p, std::memory_order order) noexcept
+  {
+    reset();
+    // the guard has to be announced before we load p
+    add_guard();
     for (;;)
     {
-      reset();
       auto q = p.load(std::memory_order_relaxed);
       this->ptr = q;
       if (q.get() == nullptr)
+      {
+        remove_guard();
         return;
+      }
 
       // (5) - this acquire-fetch_add synchronizes-with the release-fetch_sub (7)
       // this ensures that a change to p becomes visible
@@ -256,23 +652,66 @@ namespace emr {
 
       if (q == p.load(order))
         return;
+
+      this->ptr.reset();
+      release_references(q.get());
     }
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  bool lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
-    guard_ptr<T, MarkedPtr>::acquire_if_equal(
-      concurrent_ptr<T>& p, const MarkedPtr& expected, std::memory_order order) noexcept
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    guard_ptr<T, MarkedPtr>::do_acquire(plain_concurrent_ptr<T>& p, std::memory_order order) noexcept
+  {
+    increment_and_validate(p, order);
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, class MarkedPtr>
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    guard_ptr<T, MarkedPtr>::do_acquire(split_concurrent_ptr<T>& p, std::memory_order order) noexcept
+  {
+    reset();
+    add_guard();
+    MarkedPtr q;
+    if (p.acquire_reference(q, order))
+    {
+      this->ptr = q;
+      if (q.get() == nullptr)
+        remove_guard();
+      return;
+    }
+
+    // the batch of p is exhausted, so we have to increment the ref_count of the target instead
+    remove_guard();
+    increment_and_validate(p, order);
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, class MarkedPtr>
+  bool lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    guard_ptr<T, MarkedPtr>::do_acquire_if_equal(
+      plain_concurrent_ptr<T>& p, const MarkedPtr& expected, std::memory_order order) noexcept
   {
     reset();
+    // the guard has to be announced before we load p
+    add_guard();
     auto q = p.load(std::memory_order_relaxed);
     if (q != expected)
+    {
+      remove_guard();
       return false;
+    }
 
     this->ptr = q;
     if (q.get() == nullptr)
+    {
+      remove_guard();
       return true;
+    }
 
     // (6) - this acquire-fetch_add synchronizes-with the release-fetch_sub (7)
     // this ensures that a change to p becomes visible
@@ -285,9 +724,30 @@ namespace emr {
     return false;
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  bool lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    guard_ptr<T, MarkedPtr>::do_acquire_if_equal(
+      split_concurrent_ptr<T>& p, const MarkedPtr& expected, std::memory_order order) noexcept
+  {
+    reset();
+    if (p.load(std::memory_order_relaxed) != expected)
+      return false;
+
+    // we only take a reference from the batch if p still points to the expected target
+    do_acquire(p, order);
+    if (this->ptr == expected)
+      return true;
+
+    reset();
+    return false;
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, class MarkedPtr>
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     guard_ptr<T, MarkedPtr>::reset() noexcept
   {
     auto p = this->ptr.get();
@@ -295,18 +755,14 @@ namespace emr {
     if (p == nullptr)
       return;
 
-    if (p->decrement_refcnt())
-    {
-      if (!p->is_destroyed())
-        p->~T();
-
-      p->push_to_free_list();
-    }
+    release_references(p);
+    remove_guard();
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, class MarkedPtr>
-  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept
   {
     if (this->ptr.get() != nullptr)
@@ -321,31 +777,267 @@ namespace emr {
     reset();
   }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr<T, N>::split_concurrent_ptr(const marked_ptr& p) noexcept :
+      word(to_word(p))
+  {
+    add_batch(p.get());
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr<T, N>::~split_concurrent_ptr()
+  {
+    release_batch(word.load(std::memory_order_relaxed));
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr<T, N>::store(const marked_ptr& src, std::memory_order order)
+  {
+    add_batch(src.get());
+    // (15) - this release-exchange synchronizes-with the acquire-fetch_add (17)
+    auto old = word.exchange(to_word(src), with_release(order));
+    release_batch(old);
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  bool lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr<T, N>::compare_exchange(
+      marked_ptr& expected, marked_ptr desired, std::memory_order success, std::memory_order failure)
+  {
+    auto old = word.load(failure);
+    if (to_marked_ptr(old) != expected)
+    {
+      expected = to_marked_ptr(old);
+      return false;
+    }
+
+    // if only the mark changes, the current batch is kept
+    const bool keep_batch = desired.get() == expected.get();
+    if (!keep_batch)
+    {
+      add_batch(desired.get());
+      success = with_release(success);
+    }
+
+    for (;;)
+    {
+      const auto new_word = to_word(desired) | (keep_batch ? (old & CountMask) : 0);
+      // (16) - if the target changes, this release-CAS synchronizes-with the acquire-fetch_add (17)
+      if (word.compare_exchange_weak(old, new_word, success, failure))
+      {
+        if (!keep_batch)
+          release_batch(old);
+        return true;
+      }
+      // a concurrent acquire only changes the count
+      if (to_marked_ptr(old) != expected)
+        break;
+    }
+
+    // only a non-null target has received a batch
+    if (!keep_batch && desired.get() != nullptr)
+      release_references(desired.get(), batch_size);
+    expected = to_marked_ptr(old);
+    return false;
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  bool lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr<T, N>::acquire_reference(marked_ptr& result, std::memory_order order)
+  {
+    // Once the batch is exhausted, the count must not be incremented any further until the batch has
+    // been replaced. This limits the overshoot to the number of threads, so the count cannot overflow.
+    auto w = word.load(std::memory_order_relaxed);
+    if (count(w) >= batch_size)
+      return false;
+
+    // (17) - this acquire-fetch_add synchronizes-with the release-exchange/CAS (15, 16, 18)
+    w = word.fetch_add(CountInc, order == std::memory_order_seq_cst ? order : std::memory_order_acquire);
+    result = to_marked_ptr(w);
+    if (result.get() == nullptr)
+      return true;
+
+    const auto n = count(w) + 1;
+    if (n > batch_size)
+      return false;
+
+    // we got the last reference of the batch, so we can safely add a new one to the target
+    if (n == batch_size)
+      replace_exhausted_batch(result.get());
+    return true;
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr<T, N>::replace_exhausted_batch(T* p)
+  {
+    add_batch(p);
+
+    // Any exhausted batch of p can be replaced, even if p has been replaced and stored again in the
+    // meantime. The increments beyond the batch size are dropped, since these threads have fallen
+    // back to incrementing the ref_count.
+    auto w = word.load(std::memory_order_relaxed);
+    while (to_marked_ptr(w).get() == p && count(w) >= batch_size)
+    {
+      // (18) - this release-CAS synchronizes-with the acquire-fetch_add (17)
+      if (word.compare_exchange_weak(w, w & ~CountMask, std::memory_order_release, std::memory_order_relaxed))
+        return;
+    }
+
+    // the batch has already been replaced by another thread or p no longer points to the target
+    release_references(p, batch_size);
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr<T, N>::add_batch(T* p)
+  {
+    if (p != nullptr)
+      p->ref_count().fetch_add(batch_size * RefCountInc, std::memory_order_relaxed);
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T, std::size_t N>
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
+    split_concurrent_ptr<T, N>::release_batch(uintptr_t w)
+  {
+    auto p = to_marked_ptr(w).get();
+    if (p == nullptr)
+      return;
+
+    // the references that have been taken from the batch are released by their guard_ptrs
+    const uintptr_t max_used = batch_size; // std::min takes its arguments by reference
+    const auto used = std::min(count(w), max_used);
+    if (used < batch_size)
+      release_references(p, static_cast<unsigned>(batch_size - used));
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  template <class T>
+  void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::release_references(T* p, unsigned refs) noexcept
+  {
+    if (!p->decrement_refcnt(refs))
+      return;
+
+    if (!SplitRefCount)
+    {
+      if (!p->is_destroyed())
+        p->~T();
+
+      p->push_to_free_list();
+      return;
+    }
+
+    // The destructor of a node releases the batches of its concurrent_ptrs, which can free further
+    // nodes. They are freed iteratively, so a long chain of removed nodes cannot overflow the stack.
+    struct release_state
+    {
+      T* pending;
+      bool is_releasing;
+    };
+    static thread_local release_state state{};
+    p->next_free.store(state.pending, std::memory_order_relaxed);
+    state.pending = p;
+    if (state.is_releasing)
+      return;
+
+    state.is_releasing = true;
+    while (state.pending != nullptr)
+    {
+      p = state.pending;
+      state.pending = p->next_free.load(std::memory_order_relaxed).get();
+      p->next_free.store(nullptr, std::memory_order_relaxed);
+      if (!p->is_destroyed())
+        p->~T();
+
+      p->push_to_free_list();
+    }
+    state.is_releasing = false;
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   template <class T, std::size_t N, class Deleter>
-  typename lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+  typename lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     template enable_concurrent_ptr<T, N, Deleter>::free_list
-    lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::
+    lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::
     enable_concurrent_ptr<T, N, Deleter>::global_free_list;
 
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  detail::thread_block_list<typename lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::guard_counter>
+    lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::guard_counters;
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  std::atomic<std::size_t> lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::trimmed_nodes;
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  inline typename lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::thread_guards&
+    lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::local_guards()
+  {
+    static thread_local thread_guards guards;
+    return guards;
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  inline void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::add_guard()
+  {
+    if (trim_free_lists)
+      local_guards().add();
+  }
+
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  inline void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::remove_guard()
+  {
+    if (trim_free_lists)
+      local_guards().remove();
+  }
+
 #ifdef TRACK_ALLOCATIONS
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
-  emr::detail::allocation_tracker lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::allocation_tracker;
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  emr::detail::allocation_tracker lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::allocation_tracker;
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
   inline emr::detail::allocation_counter&
-    lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::allocation_counter()
+    lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::allocation_counter()
   {
     static thread_local emr::detail::registered_allocation_counter<lock_free_ref_count> counter;
     return counter;
   };
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
-  inline void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::count_allocation()
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  inline void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::count_allocation()
   { allocation_counter().count_allocation(); }
 
-  template <bool InsertPadding, size_t ThreadLocalFreeListSize>
-  inline void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize>::count_reclamation()
+  template <bool InsertPadding, size_t ThreadLocalFreeListSize, size_t DepotShards, size_t FreeListWatermark,
+            bool SplitRefCount>
+  inline void lock_free_ref_count<InsertPadding, ThreadLocalFreeListSize, DepotShards, FreeListWatermark, SplitRefCount>::count_reclamation()
   { allocation_counter().count_reclamation(); }
 #endif
 }
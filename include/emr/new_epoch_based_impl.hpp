@@ -5,6 +5,7 @@
 #include "emr/detail/orphan.hpp"
 
 #include <algorithm>
+#include <thread>
 
 namespace emr {
 
@@ -146,7 +147,7 @@ namespace emr {
     {}
 
     std::atomic<bool> is_in_critical_region;
-    std::atomic<unsigned> local_epoch;
+    std::atomic<epoch_t> local_epoch;
   };
 
   template <std::size_t UpdateThreshold>
@@ -157,15 +158,14 @@ namespace emr {
       if (control_block == nullptr)
         return; // no control_block -> nothing to do
 
-      // we can skip creating an orphan in case we have no retired nodes left.
-      if (std::any_of(retire_lists.begin(), retire_lists.end(), [](auto p) { return p != nullptr; }))
-      {
-        // global_epoch - 1 (mod number_epochs) guarantees a full cycle, making sure no
-        // other thread may still have a reference to an object in one of the retire lists.
-        auto target_epoch = (global_epoch.load(std::memory_order_relaxed) + number_epochs - 1) % number_epochs;
-        assert(target_epoch < number_epochs);
-        global_thread_block_list.abandon_retired_nodes(new detail::orphan<number_epochs>(target_epoch, retire_lists));
-      }
+      // the pending deletions are already safe to reclaim
+      pending_deletions.delete_objects();
+
+      // the remaining nodes are abandoned, so other threads can adopt and reclaim them (see adopt_orphan)
+      // orphans are not counted until they get adopted
+      for (auto& list : retire_lists)
+        budget_counter.released(list.size());
+      detail::orphan::abandon(global_thread_block_list, retire_lists);
 
       assert(control_block->is_in_critical_region.load(std::memory_order_relaxed) == false);
       global_thread_block_list.release_entry(control_block);
@@ -197,7 +197,10 @@ namespace emr {
     {
       enter_region();
       if (++nested_critical_entries == 1)
+      {
         do_enter_critical();
+        incremental_reclamation::process(pending_deletions);
+      }
     }
 
     void leave_critical()
@@ -211,6 +214,41 @@ namespace emr {
       add_retired_node(p, control_block->local_epoch.load(std::memory_order_relaxed));
     }
 
+    void synchronize()
+    {
+      assert(region_entries == 0 && "synchronize must not be called while holding a guard_ptr or region_guard");
+      ensure_has_control_block();
+
+      // The orphans have been abandoned before we read the epoch, so they are safe to reclaim
+      // once it has been advanced number_epochs times - just like our own retired nodes.
+      auto orphans = adopt_orphans();
+      const auto start_epoch = global_epoch.load(std::memory_order_relaxed);
+      orphans.consume([this, start_epoch](detail::deletable_object* p) { add_retired_node(p, start_epoch); });
+
+      epoch_t epoch;
+      // (8) - this acquire-load synchronizes-with the release-CAS (7)
+      while ((epoch = global_epoch.load(std::memory_order_acquire)) < start_epoch + number_epochs)
+      {
+        if (!try_update_epoch(epoch, epoch + 1))
+          std::this_thread::yield();
+      }
+      control_block->local_epoch.store(epoch, std::memory_order_relaxed);
+      flush_retire_lists(epoch);
+    }
+
+    bool try_flush()
+    {
+      assert(region_entries == 0 && "try_flush must not be called while holding a guard_ptr or region_guard");
+      ensure_has_control_block();
+
+      // (9) - this acquire-load synchronizes-with the release-CAS (7)
+      auto epoch = global_epoch.load(std::memory_order_acquire);
+      if (try_update_epoch(epoch, epoch + 1))
+        epoch = epoch + 1;
+      control_block->local_epoch.store(epoch, std::memory_order_relaxed);
+      return flush_retire_lists(epoch);
+    }
+
   private:
     void ensure_has_control_block()
     {
@@ -228,10 +266,10 @@ namespace emr {
       {
         critical_entries_since_update = 0;
       }
-      else if (critical_entries_since_update++ == UpdateThreshold)
+      else if (critical_entries_since_update++ >= memory_budget::threshold(UpdateThreshold))
       {
         critical_entries_since_update = 0;
-        const auto new_epoch = (epoch + 1) % number_epochs;
+        const auto new_epoch = epoch + 1;
         if (!try_update_epoch(epoch, new_epoch))
           return;
 
@@ -241,26 +279,63 @@ namespace emr {
         return;
 
       // we either just updated the global_epoch or we are observing a new epoch from some other thread
-      // either way - we can reclaim all the objects from the old 'incarnation' of this epoch
+      // either way - we can reclaim all the objects that have been retired at least number_epochs
+      // epochs ago; after a stall this might well be more than one retire list
 
       control_block->local_epoch.store(epoch, std::memory_order_relaxed);
-      detail::delete_objects(retire_lists[epoch]);
+      reclaim_retire_lists(epoch);
+    }
+
+    // The retire lists are keyed by the absolute epoch in which the nodes have been retired.
+    // A thread's local epoch only increases and whenever it changes all lists that are old enough
+    // get reclaimed, so a list can only contain nodes of a different epoch if these are already
+    // safe to reclaim - in this case we simply treat them as if they were retired in the later epoch.
+    void add_retired_node(detail::deletable_object* p, epoch_t epoch)
+    {
+      const auto idx = epoch % number_epochs;
+      retire_list_epochs[idx] = epoch;
+      retire_lists[idx].push(p);
+      budget_counter.retired();
+    }
+
+    // Reclaims all retire lists with nodes that have been retired no later than
+    // in epoch - number_epochs.
+    void reclaim_retire_lists(epoch_t epoch)
+    {
+      for (std::size_t i = 0; i < number_epochs; ++i)
+      {
+        if (retire_list_epochs[i] + number_epochs <= epoch)
+        {
+          budget_counter.released(retire_lists[i].size());
+          incremental_reclamation::delete_objects(retire_lists[i], pending_deletions);
+        }
+      }
     }
 
-    void add_retired_node(detail::deletable_object* p, size_t epoch)
+    // Deletes all retired nodes that are safe to reclaim in the given epoch right away, i.e.,
+    // bypassing incremental and background reclamation. Returns true if no retired nodes are left.
+    bool flush_retire_lists(epoch_t epoch)
     {
-      assert(epoch < number_epochs);
-      p->next = retire_lists[epoch];
-      retire_lists[epoch] = p;
+      pending_deletions.delete_objects();
+      bool result = true;
+      for (std::size_t i = 0; i < number_epochs; ++i)
+      {
+        if (retire_list_epochs[i] + number_epochs <= epoch)
+        {
+          budget_counter.released(retire_lists[i].size());
+          retire_lists[i].delete_objects();
+        }
+        result = result && retire_lists[i].empty();
+      }
+      return result;
     }
 
-    bool try_update_epoch(unsigned curr_epoch, unsigned new_epoch)
+    bool try_update_epoch(epoch_t curr_epoch, epoch_t new_epoch)
     {
-      const auto old_epoch = (curr_epoch + number_epochs - 1) % number_epochs;
-      auto prevents_update = [old_epoch](const thread_control_block& data)
+      auto prevents_update = [curr_epoch](const thread_control_block& data)
       {
         return data.is_in_critical_region.load(std::memory_order_relaxed) &&
-               data.local_epoch.load(std::memory_order_relaxed) == old_epoch;
+               data.local_epoch.load(std::memory_order_relaxed) < curr_epoch;
       };
 
       // If any thread hasn't advanced to the current epoch, abort the attempt.
@@ -274,12 +349,12 @@ namespace emr {
         // (6) - this acquire-fence synchronizes-with the release-store (4)
         std::atomic_thread_fence(std::memory_order_acquire);
 
-        // (7) - this release-CAS synchronizes-with the acquire-load (5)
+        // (7) - this release-CAS synchronizes-with the acquire-loads (5, 8, 9)
         bool success = global_epoch.compare_exchange_strong(curr_epoch, new_epoch,
                                                             std::memory_order_release,
                                                             std::memory_order_relaxed);
         if (success)
-          adopt_orphans();
+          adopt_orphan(new_epoch);
       }
 
       // return true regardless of whether the CAS operation was successful or not
@@ -287,34 +362,71 @@ namespace emr {
       return true;
     }
 
-    void adopt_orphans()
+    // Adopts at most one orphan per epoch update, so the nodes of terminated threads
+    // get distributed over several updates (and threads).
+    // The orphan is added to the retire list of the previous epoch which gets reclaimed
+    // when new_epoch + 2 is reached. The nodes have been retired before the orphan was
+    // abandoned, i.e., no later than in new_epoch, so this guarantees a full cycle.
+    void adopt_orphan(epoch_t new_epoch)
     {
-      auto cur = global_thread_block_list.adopt_abandoned_retired_nodes();
-      for (detail::deletable_object* next = nullptr; cur != nullptr; cur = next)
-      {
-        next = cur->next;
-        cur->next = nullptr;
-        add_retired_node(cur, static_cast<detail::orphan<number_epochs>*>(cur)->target_epoch);
-      }
+      auto orphan = global_thread_block_list.try_adopt_abandoned_retired_node();
+      if (orphan != nullptr)
+        add_retired_node(orphan, new_epoch - 1);
+    }
+
+    // Adopts all orphans that are currently available.
+    detail::retire_list adopt_orphans()
+    {
+      detail::retire_list result;
+      while (auto orphan = global_thread_block_list.try_adopt_abandoned_retired_node())
+        result.push(orphan);
+      return result;
     }
 
     unsigned critical_entries_since_update = 0;
     unsigned nested_critical_entries = 0;
     unsigned region_entries = 0;
     thread_control_block* control_block = nullptr;
-    std::array<detail::deletable_object*, number_epochs> retire_lists = {};
+    std::array<detail::retire_list, number_epochs> retire_lists;
+    std::array<epoch_t, number_epochs> retire_list_epochs{};
+    detail::retire_list pending_deletions;
+    typename memory_budget::thread_counter budget_counter;
 
     friend class new_epoch_based;
     ALLOCATION_COUNTER(new_epoch_based);
   };
 
   template <std::size_t UpdateThreshold>
-  std::atomic<unsigned> new_epoch_based<UpdateThreshold>::global_epoch;
+  std::atomic<typename new_epoch_based<UpdateThreshold>::epoch_t> new_epoch_based<UpdateThreshold>::global_epoch;
 
   template <std::size_t UpdateThreshold>
   detail::thread_block_list<typename new_epoch_based<UpdateThreshold>::thread_control_block>
     new_epoch_based<UpdateThreshold>::global_thread_block_list;
 
+  template <std::size_t UpdateThreshold>
+  void new_epoch_based<UpdateThreshold>::synchronize()
+  {
+    local_thread_data().synchronize();
+  }
+
+  template <std::size_t UpdateThreshold>
+  bool new_epoch_based<UpdateThreshold>::try_flush()
+  {
+    return local_thread_data().try_flush();
+  }
+
+  template <std::size_t UpdateThreshold>
+  template <class Func>
+  void new_epoch_based<UpdateThreshold>::retire(Func&& f)
+  {
+    auto node = detail::deferred_callback<detail::deletable_object>::create(std::forward<Func>(f));
+    auto& data = local_thread_data();
+    // the node is tagged with the local epoch, which is only up to date inside a critical region
+    data.enter_critical();
+    data.add_retired_node(node);
+    data.leave_critical();
+  }
+
   template <std::size_t UpdateThreshold>
   inline typename new_epoch_based<UpdateThreshold>::thread_data& new_epoch_based<UpdateThreshold>::local_thread_data()
   {
@@ -5,9 +5,16 @@
 #include <emr/detail/deletable_object.hpp>
 #include <emr/detail/thread_block_list.hpp>
 #include <emr/detail/allocation_tracker.hpp>
+#include <emr/detail/background_reclaimer.hpp>
+#include <emr/detail/deferred_callback.hpp>
+#include <emr/detail/incremental_reclaimer.hpp>
+#include <emr/detail/reclamation_budget.hpp>
 
 #include <emr/acquire_guard.hpp>
 
+#include <cstdint>
+#include <limits>
+
 namespace emr {
 
   class quiescent_state_based
@@ -33,14 +40,48 @@ namespace emr {
     template <class T, std::size_t N = T::number_of_mark_bits>
     using concurrent_ptr = emr::detail::concurrent_ptr<T, N, guard_ptr>;
 
+    using background_reclamation = detail::background_reclaimer<quiescent_state_based>;
+    using incremental_reclamation = detail::incremental_reclaimer<quiescent_state_based>;
+    using memory_budget = detail::reclamation_budget<quiescent_state_based>;
+
+    // Puts the calling thread into an extended quiescent state, similar to userspace RCU's
+    // rcu_thread_offline. While a thread is offline it does not prevent the epoch from being
+    // advanced, so threads that are about to block (e.g., waiting for I/O or for new tasks
+    // in a thread pool) should go offline to allow the other threads to reclaim memory.
+    // An offline thread must not hold any guard_ptr or region_guard and must not access
+    // any shared objects until it calls thread_online.
+    static void thread_offline();
+    static void thread_online();
+
+    // Passes through quiescent states until all nodes retired by the calling thread are safe to
+    // reclaim, and deletes them. Abandoned nodes are adopted on the way, but while another thread
+    // is adopting some, these are left to that thread. Must be called by an online thread outside
+    // of any region, otherwise it would block its own grace period.
+    static void synchronize();
+
+    // Passes through a single quiescent state and deletes all retired nodes of the calling thread
+    // that are safe to reclaim. Returns true if none are left.
+    static bool try_flush();
+
+    // Defers the call of f until every online thread has passed through a quiescent state
+    // (like call_rcu), e.g., to free a buffer that is only reachable through some node.
+    // Must be called by an online thread.
+    template <class Func>
+    static void retire(Func&& f);
+
     ALLOCATION_TRACKER;
   private:
-    static constexpr unsigned number_epochs = 3;
+    // Epochs are monotonically increasing (a 64bit counter does not overflow in practice).
+    using epoch_t = std::uint64_t;
+
+    static constexpr epoch_t number_epochs = 3;
+    // the local_epoch of threads that are offline
+    static constexpr epoch_t offline_epoch = std::numeric_limits<epoch_t>::max();
 
     struct thread_data;
     struct thread_control_block;
 
-    static std::atomic<unsigned> global_epoch;
+    static std::atomic<epoch_t> global_epoch;
     static detail::thread_block_list<thread_control_block> global_thread_block_list;
 
     static thread_data& local_thread_data();
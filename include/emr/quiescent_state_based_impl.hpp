@@ -6,13 +6,14 @@
 #include "emr/detail/port.hpp"
 
 #include <algorithm>
+#include <thread>
 
 namespace emr {
 
   struct quiescent_state_based::thread_control_block :
     detail::thread_block_list<thread_control_block>::entry
   {
-    std::atomic<unsigned> local_epoch;
+    std::atomic<epoch_t> local_epoch;
   };
 
   struct quiescent_state_based::thread_data
@@ -22,21 +23,21 @@ namespace emr {
       if (control_block == nullptr)
         return; // no control_block -> nothing to do
 
-      // we can skip creating an orphan in case we have no retired nodes left.
-      if (std::any_of(retire_lists.begin(), retire_lists.end(), [](auto p) { return p != nullptr; }))
-      {
-        // global_epoch - 1 (mod number_epochs) guarantees a full cycle, making sure no
-        // other thread may still have a reference to an object in one of the retire lists.
-        auto target_epoch = (global_epoch.load(std::memory_order_relaxed) + number_epochs - 1) % number_epochs;
-        assert(target_epoch < number_epochs);
-        global_thread_block_list.abandon_retired_nodes(new detail::orphan<number_epochs>(target_epoch, retire_lists));
-      }
+      // the pending deletions are already safe to reclaim
+      pending_deletions.delete_objects();
+
+      // the remaining nodes are abandoned, so other threads can adopt and reclaim them (see adopt_orphan)
+      // orphans are not counted until they get adopted
+      for (auto& list : retire_lists)
+        budget_counter.released(list.size());
+      detail::orphan::abandon(global_thread_block_list, retire_lists);
 
       global_thread_block_list.release_entry(control_block);
     }
 
     void enter_region()
     {
+      assert(!is_offline && "offline threads must not access shared objects");
       ensure_has_control_block();
       ++region_entries;
     }
@@ -44,7 +45,10 @@ namespace emr {
     void leave_region()
     {
       if (--region_entries == 0)
+      {
         quiescent_state();
+        incremental_reclamation::process(pending_deletions);
+      }
     }
 
     void add_retired_node(detail::deletable_object* p)
@@ -52,24 +56,82 @@ namespace emr {
       add_retired_node(p, control_block->local_epoch.load(std::memory_order_relaxed));
     }
 
+    void go_offline()
+    {
+      assert(!is_offline);
+      assert(region_entries == 0 && "a thread must not go offline inside a region");
+      is_offline = true;
+      if (control_block == nullptr)
+        return; // the thread will join the current epoch once it gets a control_block
+
+      // (8) - this release-store synchronizes-with the acquire-fence (4)
+      control_block->local_epoch.store(offline_epoch, std::memory_order_release);
+    }
+
+    void go_online()
+    {
+      assert(is_offline);
+      is_offline = false;
+      if (control_block != nullptr)
+      {
+        join_current_epoch();
+        // the epoch might have advanced several times while we were offline
+        reclaim_retire_lists(control_block->local_epoch.load(std::memory_order_relaxed));
+      }
+    }
+
+    void synchronize()
+    {
+      assert(!is_offline && region_entries == 0 && "synchronize must only be called in a quiescent state");
+      ensure_has_control_block();
+
+      // The orphans have been abandoned before we read the epoch, so they are safe to reclaim
+      // once it has been advanced number_epochs times - just like our own retired nodes.
+      auto orphans = adopt_orphans();
+      const auto start_epoch = global_epoch.load(std::memory_order_relaxed);
+      orphans.consume([this, start_epoch](detail::deletable_object* p) { add_retired_node(p, start_epoch); });
+
+      for (;;)
+      {
+        quiescent_state();
+        if (control_block->local_epoch.load(std::memory_order_relaxed) >= start_epoch + number_epochs)
+          break;
+        std::this_thread::yield();
+      }
+      flush_retire_lists(control_block->local_epoch.load(std::memory_order_relaxed));
+    }
+
+    bool try_flush()
+    {
+      assert(!is_offline && region_entries == 0 && "try_flush must only be called in a quiescent state");
+      ensure_has_control_block();
+      quiescent_state();
+      return flush_retire_lists(control_block->local_epoch.load(std::memory_order_relaxed));
+    }
+
   private:
     void ensure_has_control_block()
     {
       if (control_block == nullptr)
       {
         control_block = global_thread_block_list.acquire_entry();
-        auto epoch = global_epoch.load(std::memory_order_relaxed);
-        do {
-          control_block->local_epoch.store(epoch, std::memory_order_relaxed);
-
-          // (1) - this acq_rel-CAS synchronizes-with the acquire-load (2)
-          //       and the acq_rel-CAS (5)
-        } while (!global_epoch.compare_exchange_weak(epoch, epoch,
-                                                     std::memory_order_acq_rel,
-                                                     std::memory_order_relaxed));
+        join_current_epoch();
       }
     }
 
+    void join_current_epoch()
+    {
+      auto epoch = global_epoch.load(std::memory_order_relaxed);
+      do {
+        control_block->local_epoch.store(epoch, std::memory_order_relaxed);
+
+        // (1) - this acq_rel-CAS synchronizes-with the acquire-load (2)
+        //       and the acq_rel-CAS (5)
+      } while (!global_epoch.compare_exchange_weak(epoch, epoch,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed));
+    }
+
     void quiescent_state()
     {
       // (2) - this acquire-load synchronizes-with the acq_rel-CAS (1, 5)
@@ -77,7 +139,7 @@ namespace emr {
 
       if (control_block->local_epoch.load(std::memory_order_relaxed) == epoch)
       {
-        const auto new_epoch = (epoch + 1) % number_epochs;
+        const auto new_epoch = epoch + 1;
         if (!try_update_epoch(epoch, new_epoch))
           return;
 
@@ -85,27 +147,64 @@ namespace emr {
       }
 
       // we either just updated the global_epoch or we are observing a new epoch from some other thread
-      // either way - we can reclaim all the objects from the old 'incarnation' of this epoch
+      // either way - we can reclaim all the objects that have been retired at least number_epochs
+      // epochs ago; after a stall this might well be more than one retire list
 
       // (3) - this release-store synchronizes-with the acquire-fence (4)
       control_block->local_epoch.store(epoch, std::memory_order_release);
-      detail::delete_objects(retire_lists[epoch]);
+      reclaim_retire_lists(epoch);
     }
 
-    void add_retired_node(detail::deletable_object* p, size_t epoch)
+    // The retire lists are keyed by the absolute epoch in which the nodes have been retired.
+    // A thread's local epoch only increases and whenever it changes all lists that are old enough
+    // get reclaimed, so a list can only contain nodes of a different epoch if these are already
+    // safe to reclaim - in this case we simply treat them as if they were retired in the later epoch.
+    void add_retired_node(detail::deletable_object* p, epoch_t epoch)
     {
-      assert(epoch < number_epochs);
-      p->next = retire_lists[epoch];
-      retire_lists[epoch] = p;
+      const auto idx = epoch % number_epochs;
+      retire_list_epochs[idx] = epoch;
+      retire_lists[idx].push(p);
+      budget_counter.retired();
     }
 
-    bool try_update_epoch(unsigned curr_epoch, unsigned new_epoch)
+    // Reclaims all retire lists with nodes that have been retired no later than
+    // in epoch - number_epochs.
+    void reclaim_retire_lists(epoch_t epoch)
     {
-      const auto old_epoch = (curr_epoch + number_epochs - 1) % number_epochs;
-      auto prevents_update = [old_epoch](const thread_control_block& data)
+      for (std::size_t i = 0; i < number_epochs; ++i)
+      {
+        if (retire_list_epochs[i] + number_epochs <= epoch)
+        {
+          budget_counter.released(retire_lists[i].size());
+          incremental_reclamation::delete_objects(retire_lists[i], pending_deletions);
+        }
+      }
+    }
+
+    // Deletes all retired nodes that are safe to reclaim in the given epoch right away, i.e.,
+    // bypassing incremental and background reclamation. Returns true if no retired nodes are left.
+    bool flush_retire_lists(epoch_t epoch)
+    {
+      pending_deletions.delete_objects();
+      bool result = true;
+      for (std::size_t i = 0; i < number_epochs; ++i)
+      {
+        if (retire_list_epochs[i] + number_epochs <= epoch)
+        {
+          budget_counter.released(retire_lists[i].size());
+          retire_lists[i].delete_objects();
+        }
+        result = result && retire_lists[i].empty();
+      }
+      return result;
+    }
+
+    bool try_update_epoch(epoch_t curr_epoch, epoch_t new_epoch)
+    {
+      auto prevents_update = [curr_epoch](const thread_control_block& data)
       {
         return data.is_active() &&
-               data.local_epoch.load(std::memory_order_relaxed) == old_epoch;
+               data.local_epoch.load(std::memory_order_relaxed) < curr_epoch;
       };
 
       // If any thread hasn't advanced to the current epoch, abort the attempt.
@@ -116,7 +215,7 @@ namespace emr {
 
       if (global_epoch.load(std::memory_order_relaxed) == curr_epoch)
       {
-        // (4) - this acquire-fence synchronizes-with the release-store (3)
+        // (4) - this acquire-fence synchronizes-with the release-stores (3, 8)
         std::atomic_thread_fence(std::memory_order_acquire);
 
         // (5) - this acq_rel-CAS synchronizes-with the acquire-load (2)
@@ -125,7 +224,7 @@ namespace emr {
                                                             std::memory_order_acq_rel,
                                                             std::memory_order_relaxed);
         if (success)
-          adopt_orphans();
+          adopt_orphan(new_epoch);
       }
 
       // return true regardless of whether the CAS operation was successful or not
@@ -133,25 +232,69 @@ namespace emr {
       return true;
     }
 
-    void adopt_orphans()
+    // Adopts at most one orphan per epoch update, so the nodes of terminated threads
+    // get distributed over several updates (and threads).
+    // The orphan is added to the retire list of the previous epoch which gets reclaimed
+    // when new_epoch + 2 is reached. The nodes have been retired before the orphan was
+    // abandoned, i.e., no later than in new_epoch, so this guarantees a full cycle.
+    void adopt_orphan(epoch_t new_epoch)
     {
-      auto cur = global_thread_block_list.adopt_abandoned_retired_nodes();
-      for (detail::deletable_object* next = nullptr; cur != nullptr; cur = next)
-      {
-        next = cur->next;
-        cur->next = nullptr;
-        add_retired_node(cur, static_cast<detail::orphan<number_epochs>*>(cur)->target_epoch);
-      }
+      auto orphan = global_thread_block_list.try_adopt_abandoned_retired_node();
+      if (orphan != nullptr)
+        add_retired_node(orphan, new_epoch - 1);
+    }
+
+    // Adopts all orphans that are currently available.
+    detail::retire_list adopt_orphans()
+    {
+      detail::retire_list result;
+      while (auto orphan = global_thread_block_list.try_adopt_abandoned_retired_node())
+        result.push(orphan);
+      return result;
     }
 
     unsigned region_entries = 0;
+    bool is_offline = false;
     thread_control_block* control_block = nullptr;
-    std::array<detail::deletable_object*, number_epochs> retire_lists = {};
+    std::array<detail::retire_list, number_epochs> retire_lists;
+    std::array<epoch_t, number_epochs> retire_list_epochs{};
+    detail::retire_list pending_deletions;
+    memory_budget::thread_counter budget_counter;
 
     friend class quiescent_state_based;
     ALLOCATION_COUNTER(quiescent_state_based);
   };
 
+  inline void quiescent_state_based::thread_offline()
+  {
+    local_thread_data().go_offline();
+  }
+
+  inline void quiescent_state_based::thread_online()
+  {
+    local_thread_data().go_online();
+  }
+
+  inline void quiescent_state_based::synchronize()
+  {
+    local_thread_data().synchronize();
+  }
+
+  inline bool quiescent_state_based::try_flush()
+  {
+    return local_thread_data().try_flush();
+  }
+
+  template <class Func>
+  void quiescent_state_based::retire(Func&& f)
+  {
+    auto node = detail::deferred_callback<detail::deletable_object>::create(std::forward<Func>(f));
+    auto& data = local_thread_data();
+    data.enter_region();
+    data.add_retired_node(node);
+    data.leave_region();
+  }
+
   inline quiescent_state_based::region_guard::region_guard() noexcept
   {
       local_thread_data().enter_region();
@@ -276,7 +419,7 @@ namespace emr {
     return local_thread_data;
   }
 
-  SELECT_ANY std::atomic<unsigned> quiescent_state_based::global_epoch;
+  SELECT_ANY std::atomic<quiescent_state_based::epoch_t> quiescent_state_based::global_epoch;
   SELECT_ANY detail::thread_block_list<quiescent_state_based::thread_control_block>
     quiescent_state_based::global_thread_block_list;
 
@@ -4,6 +4,9 @@
 #include <emr/detail/guard_ptr.hpp>
 #include <emr/detail/deletable_object.hpp>
 #include <emr/detail/allocation_tracker.hpp>
+#include <emr/detail/background_reclaimer.hpp>
+#include <emr/detail/reclamation_budget.hpp>
+#include <emr/detail/deferred_callback.hpp>
 
 #include <emr/acquire_guard.hpp>
 
@@ -40,28 +43,76 @@ namespace emr {
       size_t remove_calls = 0;
       size_t remove_next_iterations = 0;
       size_t remove_prev_iterations = 0;
+      size_t lazy_region_exits = 0;
     };
     static performance_counters get_performance_counters();
+    // the counters of the threads that have been assigned to the given shard
+    static performance_counters get_performance_counters(unsigned shard);
 #endif
 
+    // The threads are distributed round-robin over several thread order queues ("shards") that
+    // share a common stamp; a node can be reclaimed once the tail stamps of all shards have passed
+    // its stamp. More shards reduce the contention on the queues' head, but make the computation
+    // of the combined tail stamp more expensive. Only threads that enter their first region after
+    // the call are affected. The default is a single queue.
+    static constexpr unsigned max_shards = 16;
+    static void set_number_of_shards(unsigned n);
+    static unsigned number_of_shards();
+
+    // Lazy region exit: when a thread leaves its region, its control block stays in the queue
+    // for up to max_cached_regions subsequent regions, so that short back-to-back regions do not
+    // have to perform a push and a remove operation each. The block is removed for real once this
+    // limit is reached or the thread has accumulated so many retired nodes that it needs the tail
+    // stamp to advance. Until then the thread holds back the reclamation of all nodes retired
+    // after its cached region has started. If other threads cannot reclaim their nodes because
+    // the oldest block of a queue is cached, they remove it on behalf of its owner, so an idle
+    // thread does not block the reclamation forever. synchronize and try_flush always leave a
+    // cached region.
+    static void enable_lazy_region_exit(unsigned max_cached_regions);
+    static void disable_lazy_region_exit();
+    static unsigned max_cached_regions();
+
+    using background_reclamation = detail::background_reclaimer<stamp_it>;
+    using memory_budget = detail::reclamation_budget<stamp_it>;
+
+    // Waits until all threads that were inside a region at the time of the call have left it, and
+    // then reclaims the retired nodes of the calling thread and the nodes in the global retire-list.
+    // Must not be called inside a region.
+    static void synchronize();
+
+    // Reclaims all nodes from the local and the global retire-list that are safe to reclaim,
+    // without waiting for other threads. Returns true if no nodes remain.
+    static bool try_flush();
+
+    // Defers the call of f until all threads that are currently inside a region have left it
+    // (like call_rcu), e.g., to free a buffer that is only reachable through some node.
+    template <class Func>
+    static void retire(Func&& f);
+
     ALLOCATION_TRACKER;
   private:
     static constexpr size_t MarkBits = 18;
+    // If upper mark bits are available (see WITH_UPPER_MARK_BITS), most of the mark bits of the queue's
+    // pointers are stored there, so the control blocks only need to be cache line aligned (instead of 256 KiB).
+    static constexpr size_t LowMarkBits = detail::upper_mark_bits_available ? 6 : MarkBits;
 
     using stamp_t = size_t;
 
     struct deletable_object_with_stamp;
     struct thread_control_block;
     struct thread_data;
+    struct deferred_deletion_batch;
 
     class thread_order_queue;
+    class sharded_thread_order_queue;
 
     static constexpr stamp_t NotInList = 1;
     static constexpr stamp_t PendingPush = 2;
     static constexpr stamp_t StampInc = 4;
 
     static thread_data& local_thread_data();
-    static thread_order_queue queue;
+    static sharded_thread_order_queue queue;
+    static std::atomic<unsigned> lazy_exit_regions;
 
     ALLOCATION_TRACKING_FUNCTIONS;
   };
@@ -8,40 +8,56 @@
 #include "detail/thread_block_list.hpp"
 
 #include <algorithm>
+#include <limits>
+#include <thread>
 
 namespace emr {
 
   struct stamp_it::thread_control_block :
-    detail::aligned_object<thread_control_block, 1 << MarkBits>,
+    detail::aligned_object<thread_control_block, 1 << LowMarkBits>,
     detail::thread_block_list<thread_control_block>::entry
   {
-    using concurrent_ptr = std::atomic<detail::marked_ptr<thread_control_block, MarkBits>>;
+    using concurrent_ptr = std::atomic<detail::marked_ptr<thread_control_block, MarkBits, LowMarkBits>>;
 
     concurrent_ptr prev;
     concurrent_ptr next;
 
     std::atomic<stamp_t> stamp;
 
+    // Only used in lazy region exit mode: while the owner has left its region but keeps the block
+    // in the queue (cached), another thread may remove the block on the owner's behalf (evicting).
+    enum : unsigned { not_cached, cached, evicting };
+    std::atomic<unsigned> region_cache{not_cached};
+
 #ifdef WITH_PERF_COUNTER
     performance_counters counters;
     friend class thread_order_queue;
 #endif
   };
 
-  class stamp_it::thread_order_queue
+  // The queue of a single shard. All shards draw their stamps from the same counter, which takes
+  // the role of the head's stamp; i.e., the stamps in each queue are still strictly increasing
+  // and all tail stamps can be compared with each other.
+  class stamp_it::thread_order_queue : public detail::aligned_object<thread_order_queue>
   {
   public:
-    using marked_ptr = detail::marked_ptr<thread_control_block, MarkBits>;
+    using marked_ptr = detail::marked_ptr<thread_control_block, MarkBits, LowMarkBits>;
     using concurrent_ptr = std::atomic<marked_ptr>;
 
-    thread_order_queue()
+    explicit thread_order_queue(std::atomic<stamp_t>& stamp_counter) :
+      stamp_counter(stamp_counter)
     {
       head = new thread_control_block();
       tail = new thread_control_block();
       tail->next.store(head, std::memory_order_relaxed);
       tail->stamp.store(StampInc, std::memory_order_relaxed);
       head->prev.store(tail, std::memory_order_relaxed);
-      head->stamp.store(StampInc, std::memory_order_relaxed);
+    }
+
+    ~thread_order_queue()
+    {
+      delete head;
+      delete tail;
     }
 
     void push(thread_control_block* block)
@@ -70,7 +86,7 @@ namespace emr {
         // fetch a new stamp and set the PendingPush flag
         // (2) - this seq_cst-fetch-add enforces a total order with (12)
         //       and synchronizes-with the acquire-loads (19, 23)
-        stamp = head->stamp.fetch_add(StampInc, std::memory_order_seq_cst);
+        stamp = stamp_counter.fetch_add(StampInc, std::memory_order_seq_cst);
         auto pending_stamp = stamp - (StampInc - PendingPush);
         assert((pending_stamp & PendingPush) && !(pending_stamp & NotInList));
 
@@ -161,39 +177,53 @@ namespace emr {
       return wasTail;
     }
 
-    void add_to_global_retired_nodes(deletable_object_with_stamp* chunk)
-    {
-      add_to_global_retired_nodes(chunk, chunk);
+    stamp_t tail_stamp() {
+      // (13) - this acquire-load synchronizes-with the release-CAS (16)
+      return tail->stamp.load(std::memory_order_acquire);
     }
 
-    void add_to_global_retired_nodes(deletable_object_with_stamp* first_chunk, deletable_object_with_stamp* last_chunk)
+    // If the oldest block belongs to a thread that has left its region but keeps the block
+    // cached (see enable_lazy_region_exit), we remove the block on behalf of that thread;
+    // otherwise an idle thread would hold back the tail stamp forever.
+    // Returns true if a block has been removed.
+    bool evict_cached_tail()
     {
-      assert(first_chunk != nullptr && last_chunk != nullptr);
-      auto n = global_retired_nodes.load(std::memory_order_relaxed);
-      do
-      {
-        last_chunk->next_chunk = n;
-        // (10) - this release-CAS synchronizes-with the acquire_xchg (11)
-      } while (!global_retired_nodes.compare_exchange_weak(n, first_chunk,
-                                                           std::memory_order_release,
-                                                           std::memory_order_relaxed));
+      // control blocks are never freed, so it does not matter if last is removed concurrently
+      auto last = tail->next.load(std::memory_order_relaxed);
+      if (last.get() == head)
+        return false;
+
+      unsigned expected = thread_control_block::cached;
+      if (last->region_cache.load(std::memory_order_relaxed) != expected ||
+          // (34) - this acquire-CAS synchronizes-with the release-store (33)
+          !last->region_cache.compare_exchange_strong(expected, thread_control_block::evicting,
+                                                      std::memory_order_acquire,
+                                                      std::memory_order_relaxed))
+        return false;
+
+      remove(marked_ptr(last.get()));
+      // the queue might be empty now; its owner is idle, so nobody else would advance the tail stamp
+      refresh_tail_stamp();
+      // (35) - this release-store synchronizes-with the acquire-load (36)
+      last->region_cache.store(thread_control_block::not_cached, std::memory_order_release);
+      return true;
     }
 
-    deletable_object_with_stamp* steal_global_retired_nodes()
+    // The tail stamp of an empty queue is only updated by the last remove operation, but in the
+    // meantime the threads of the other shards keep incrementing the shared stamp. So if the queue
+    // is empty we try to move its tail stamp up to the current head stamp, otherwise it would hold
+    // back the combined tail stamp until some thread of this shard enters and leaves a region.
+    stamp_t refresh_tail_stamp()
     {
-      if (global_retired_nodes.load(std::memory_order_relaxed) != nullptr)
-        // (11) - this acquire-xchg synchronizes-with the release-CAS (10)
-        return global_retired_nodes.exchange(nullptr, std::memory_order_acquire);
-      return nullptr;
-    }
-
-    stamp_t head_stamp() {
-      // (12) - this seq-cst-load enforces a total order with (2)
-      return head->stamp.load(std::memory_order_seq_cst);
-    }
-    stamp_t tail_stamp() {
-      // (13) - this acquire-load synchronizes-with the release-CAS (16)
-      return tail->stamp.load(std::memory_order_acquire);
+      auto stamp = tail_stamp();
+      if (tail->next.load(std::memory_order_relaxed).get() == head)
+      {
+        // update_tail_stamp only takes the head stamp if it is more than one increment
+        // ahead of the passed stamp, but we want to catch up with every increment.
+        update_tail_stamp(stamp - StampInc);
+        stamp = tail_stamp();
+      }
+      return stamp;
     }
 
     thread_control_block* acquire_control_block()
@@ -217,6 +247,14 @@ namespace emr {
       return marked_ptr(p, (m.mark() + TagInc) & MarkMask & ~DeleteMark);
     }
 
+    // Returns the stamp of the given block, where the stamp of head is the shared stamp counter.
+    stamp_t load_stamp(marked_ptr block, std::memory_order order)
+    {
+      if (block.get() == head)
+        return stamp_counter.load(order);
+      return block->stamp.load(order);
+    }
+
     void update_tail_stamp(size_t stamp)
     {
       // In the best case the stamp of tail equals the stamp of tail's predecessor (in prev
@@ -228,7 +266,7 @@ namespace emr {
       auto last = tail->next.load(std::memory_order_acquire);
       // (15) - this acquire-load synchronizes-with the release-stores (4, 5, 9, 21, 28)
       auto last_prev = last->prev.load(std::memory_order_acquire);
-      auto last_stamp = last->stamp.load(std::memory_order_relaxed);
+      auto last_stamp = load_stamp(last, std::memory_order_relaxed);
       if (last_stamp > stamp &&
           last_prev.get() == tail &&
           tail->next.load(std::memory_order_relaxed) == last)
@@ -317,7 +355,7 @@ namespace emr {
         // (18) - this acquire-load synchronizes-with the release-stores (4, 5, 9, 21, 28)
         auto next_prev = next->prev.load(std::memory_order_acquire);
         // (19) - this acquire-load synchronizes-with the release-stores (2, 3, 6)
-        auto next_stamp = next->stamp.load(std::memory_order_acquire);
+        auto next_stamp = load_stamp(next, std::memory_order_acquire);
 
         if (next_prev != next->prev.load(std::memory_order_relaxed))
           continue;
@@ -387,7 +425,7 @@ namespace emr {
         // (22) - this acquire-load synchronizes-with the release-stores (4, 5, 9, 21, 28)
         auto next_prev = next->prev.load(std::memory_order_acquire);
         // (23) - this acquire-load synchronizes-with the release-stores (2, 3, 6)
-        auto next_stamp = next->stamp.load(std::memory_order_acquire);
+        auto next_stamp = load_stamp(next, std::memory_order_acquire);
 
         if (next_prev != next->prev.load(std::memory_order_relaxed))
           continue;
@@ -566,17 +604,199 @@ namespace emr {
 
     thread_control_block* head;
     thread_control_block* tail;
+    std::atomic<stamp_t>& stamp_counter;
 
-    alignas(64) std::atomic<deletable_object_with_stamp*> global_retired_nodes;
     alignas(64) detail::thread_block_list<thread_control_block> global_thread_block_list;
     friend class stamp_it;
   };
 
+  class stamp_it::sharded_thread_order_queue
+  {
+  public:
+    sharded_thread_order_queue()
+    {
+      stamp_counter.store(StampInc, std::memory_order_relaxed);
+      shards[0].store(new thread_order_queue(stamp_counter), std::memory_order_relaxed);
+      for (unsigned i = 1; i < max_shards; ++i)
+        shards[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    // Assigns the calling thread to one of the shards.
+    thread_order_queue& select_shard()
+    {
+      const auto n = configured_shards.load(std::memory_order_relaxed);
+      const auto idx = next_shard.fetch_add(1, std::memory_order_relaxed) % n;
+      auto shard = get_or_create_shard(idx);
+
+      // The seq_cst operations ensure that a thread computing the combined tail stamp with a
+      // head stamp newer than any stamp of our thread also considers our shard.
+      auto used = used_shards.load(std::memory_order_seq_cst);
+      while (used < idx + 1 &&
+             !used_shards.compare_exchange_weak(used, idx + 1, std::memory_order_seq_cst))
+        ;
+      return *shard;
+    }
+
+    // The global retire-list is split into several stacks of chunks, so that the threads
+    // can add and process chunks without all contending on the same cache line.
+    static constexpr unsigned global_retired_nodes_shards = 8;
+
+    unsigned select_global_retired_nodes_shard()
+    {
+      return next_global_retired_nodes_shard.fetch_add(1, std::memory_order_relaxed) % global_retired_nodes_shards;
+    }
+
+    void add_to_global_retired_nodes(deletable_object_with_stamp* chunk, unsigned idx)
+    {
+      add_to_global_retired_nodes(chunk, chunk, idx);
+    }
+
+    void add_to_global_retired_nodes(deletable_object_with_stamp* first_chunk,
+                                     deletable_object_with_stamp* last_chunk,
+                                     unsigned idx)
+    {
+      assert(first_chunk != nullptr && last_chunk != nullptr);
+      auto& chunks = global_retired_nodes[idx % global_retired_nodes_shards].chunks;
+      auto n = chunks.load(std::memory_order_relaxed);
+      do
+      {
+        last_chunk->next_chunk = n;
+        // (10) - this release-CAS synchronizes-with the acquire_xchg (11)
+      } while (!chunks.compare_exchange_weak(n, first_chunk,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+    }
+
+    deletable_object_with_stamp* steal_global_retired_nodes(unsigned idx)
+    {
+      auto& chunks = global_retired_nodes[idx % global_retired_nodes_shards].chunks;
+      if (chunks.load(std::memory_order_relaxed) != nullptr)
+        // (11) - this acquire-xchg synchronizes-with the release-CAS (10)
+        return chunks.exchange(nullptr, std::memory_order_acquire);
+      return nullptr;
+    }
+
+    // Steals the chunks of all shards and returns them as a single list.
+    deletable_object_with_stamp* steal_global_retired_nodes()
+    {
+      deletable_object_with_stamp* result = nullptr;
+      for (unsigned i = 0; i < global_retired_nodes_shards; ++i)
+      {
+        auto first_chunk = steal_global_retired_nodes(i);
+        if (first_chunk == nullptr)
+          continue;
+
+        auto last_chunk = first_chunk;
+        while (last_chunk->next_chunk != nullptr)
+          last_chunk = last_chunk->next_chunk;
+        last_chunk->next_chunk = result;
+        result = first_chunk;
+      }
+      return result;
+    }
+
+    stamp_t head_stamp() {
+      // (12) - this seq-cst-load enforces a total order with (2)
+      return stamp_counter.load(std::memory_order_seq_cst);
+    }
+
+    // The minimum of the tail stamps of all shards. Since the tail stamps only ever increase,
+    // reading them one after another results in a conservative value.
+    stamp_t tail_stamp()
+    {
+      const auto n = used_shards.load(std::memory_order_seq_cst);
+      if (n == 1)
+        return shards[0].load(std::memory_order_relaxed)->tail_stamp();
+
+      auto result = std::numeric_limits<stamp_t>::max();
+      for (unsigned i = 0; i < n; ++i)
+      {
+        // a shard might not exist yet if a thread that was assigned to a
+        // shard with a higher index has already updated used_shards
+        auto shard = shards[i].load(std::memory_order_seq_cst);
+        if (shard != nullptr)
+          result = std::min(result, shard->refresh_tail_stamp());
+      }
+      return result;
+    }
+
+    void set_number_of_shards(unsigned n)
+    {
+      assert(n > 0 && n <= max_shards);
+      configured_shards.store(n, std::memory_order_relaxed);
+    }
+
+    unsigned number_of_shards() const { return configured_shards.load(std::memory_order_relaxed); }
+
+    // Returns true if some shard's oldest block has been evicted (see thread_order_queue::evict_cached_tail).
+    bool evict_cached_tails()
+    {
+      bool result = false;
+      const auto n = used_shards.load(std::memory_order_relaxed);
+      for (unsigned i = 0; i < n; ++i)
+      {
+        auto shard = shards[i].load(std::memory_order_acquire);
+        if (shard != nullptr && shard->evict_cached_tail())
+          result = true;
+      }
+      return result;
+    }
+
+#ifdef WITH_PERF_COUNTER
+    thread_order_queue* get_shard(unsigned idx) { return shards[idx].load(std::memory_order_acquire); }
+#endif
+
+  private:
+    thread_order_queue* get_or_create_shard(unsigned idx)
+    {
+      auto shard = shards[idx].load(std::memory_order_acquire);
+      if (shard != nullptr)
+        return shard;
+
+      auto new_shard = new thread_order_queue(stamp_counter);
+      if (shards[idx].compare_exchange_strong(shard, new_shard, std::memory_order_seq_cst, std::memory_order_acquire))
+        return new_shard;
+      delete new_shard;
+      return shard;
+    }
+
+    alignas(64) std::atomic<stamp_t> stamp_counter;
+    alignas(64) std::atomic<thread_order_queue*> shards[max_shards];
+    std::atomic<unsigned> used_shards{1};
+    std::atomic<unsigned> configured_shards{1};
+    std::atomic<unsigned> next_shard{0};
+    std::atomic<unsigned> next_global_retired_nodes_shard{0};
+
+    struct alignas(64) global_retired_nodes_shard
+    {
+      std::atomic<deletable_object_with_stamp*> chunks{nullptr};
+    };
+    global_retired_nodes_shard global_retired_nodes[global_retired_nodes_shards];
+  };
+
+  struct stamp_it::deferred_deletion_batch : detail::reclamation_batch
+  {
+    explicit deferred_deletion_batch(deletable_object_with_stamp* list) : list(list) {}
+
+    bool try_reclaim() override
+    {
+      for (deletable_object_with_stamp* next = nullptr; list != nullptr; list = next)
+      {
+        next = list->next;
+        list->delete_self();
+      }
+      return true;
+    }
+  private:
+    deletable_object_with_stamp* list;
+  };
+
   struct stamp_it::thread_data
   {
     ~thread_data()
     {
       assert(region_entries == 0);
+      leave_cached_region();
       if (control_block)
       {
         control_block->abandon();
@@ -589,7 +809,7 @@ namespace emr {
       {
         // we still have retired nodes that cannot yet be reclaimed
         // -> add them to the global list.
-        queue.add_to_global_retired_nodes(first_retired_node);
+        queue.add_to_global_retired_nodes(first_retired_node, global_shard);
       }
     }
 
@@ -597,31 +817,23 @@ namespace emr {
     {
       if (++region_entries == 1)
       {
+        if (region_cached)
+        {
+          // if our control block is still in the queue, we simply continue the cached region
+          region_cached = false;
+          if (take_back_cached_block())
+            return;
+          cached_regions = 0;
+        }
         ensure_has_control_block();
-        queue.push(control_block);
+        shard->push(control_block);
       }
     }
 
     void leave_region()
     {
-      if (--region_entries == 0)
-      {
-        auto wasLast = queue.remove(control_block);
-
-        if (wasLast)
-          process_global_nodes();
-        else
-        {
-          process_local_nodes();
-          if (number_of_retired_nodes > max_remaining_retired_nodes)
-          {
-            queue.add_to_global_retired_nodes(first_retired_node);
-            first_retired_node = nullptr;
-            prev_retired_node = &first_retired_node;
-            number_of_retired_nodes = 0;
-          }
-        }
-      }
+      if (--region_entries == 0 && !try_cache_region())
+        remove_from_queue();
     }
 
     void add_retired_node(deletable_object_with_stamp* p)
@@ -631,16 +843,123 @@ namespace emr {
       prev_retired_node = &p->next;
       
       ++number_of_retired_nodes;
-      if (number_of_retired_nodes > try_reclaim_threshold)
+      budget_counter.retired();
+      if (number_of_retired_nodes > memory_budget::threshold(try_reclaim_threshold))
         process_local_nodes();
     }
 
+    void synchronize()
+    {
+      assert(region_entries == 0 && "synchronize must not be called inside a region");
+
+      // All nodes that have been retired so far have a stamp <= the current head stamp.
+      // Our own region gets a higher stamp, so once we are the oldest thread in the queue
+      // our removal advances the tail stamp beyond it.
+      const auto stamp = queue.head_stamp();
+      leave_cached_region();
+      while (queue.tail_stamp() < stamp)
+      {
+        enter_region();
+        leave_region();
+        leave_cached_region();
+        if (queue.tail_stamp() < stamp)
+          std::this_thread::yield();
+      }
+      process_global_nodes();
+    }
+
+    bool try_flush()
+    {
+      assert(region_entries == 0 && "try_flush must not be called inside a region");
+      leave_cached_region();
+      return process_global_nodes();
+    }
+
   private:
+    void remove_from_queue()
+    {
+      shard->remove(control_block);
+      process_retired_nodes();
+    }
+
+    // Called once our control block has been removed from the queue, either by
+    // ourselves or by another thread that evicted our cached region.
+    void process_retired_nodes()
+    {
+      process_local_nodes();
+      // an idle thread that keeps its region cached might be the one that holds back the tail stamp
+      if (number_of_retired_nodes > memory_budget::threshold(max_remaining_retired_nodes) &&
+          queue.evict_cached_tails())
+        process_local_nodes();
+      if (number_of_retired_nodes > memory_budget::threshold(max_remaining_retired_nodes))
+      {
+        queue.add_to_global_retired_nodes(first_retired_node, global_shard);
+        first_retired_node = nullptr;
+        prev_retired_node = &first_retired_node;
+        number_of_retired_nodes = 0;
+      }
+
+      // Every thread that leaves its region helps to process the global retire-list, instead
+      // of leaving all the work to the thread that was the tail of the queue.
+      process_global_nodes_slice();
+    }
+
+    // Returns true if our control block stays in the queue (see enable_lazy_region_exit).
+    bool try_cache_region()
+    {
+      // If we have too many retired nodes, our region must end so the tail stamp can advance.
+      if (cached_regions >= lazy_exit_regions.load(std::memory_order_relaxed) ||
+          number_of_retired_nodes > memory_budget::threshold(max_remaining_retired_nodes))
+      {
+        cached_regions = 0;
+        return false;
+      }
+
+      INC_PERF_CNT(control_block->counters.lazy_region_exits);
+      ++cached_regions;
+      region_cached = true;
+      // from now on other threads may evict our block (see thread_order_queue::evict_cached_tail)
+      // (33) - this release-store synchronizes-with the acquire-CAS (34)
+      control_block->region_cache.store(thread_control_block::cached, std::memory_order_release);
+      return true;
+    }
+
+    void leave_cached_region()
+    {
+      if (region_cached)
+      {
+        region_cached = false;
+        cached_regions = 0;
+        if (take_back_cached_block())
+          remove_from_queue();
+        else
+          process_retired_nodes();
+      }
+    }
+
+    // Returns true if our cached block is still in the queue, or false if it has been evicted
+    // by some other thread; in the latter case we wait until the removal is complete.
+    bool take_back_cached_block()
+    {
+      unsigned expected = thread_control_block::cached;
+      if (control_block->region_cache.compare_exchange_strong(expected, thread_control_block::not_cached,
+                                                              std::memory_order_relaxed))
+        return true;
+
+      // (36) - this acquire-load synchronizes-with the release-store (35)
+      while (control_block->region_cache.load(std::memory_order_acquire) != thread_control_block::not_cached)
+        std::this_thread::yield();
+      return false;
+    }
+
     void ensure_has_control_block()
     {
       if (control_block == nullptr)
       {
-        control_block = queue.acquire_control_block();
+        // a thread stays in the same shard, since its control block belongs to this shard
+        if (shard == nullptr)
+          shard = &queue.select_shard();
+        control_block = shard->acquire_control_block();
 #ifdef WITH_PERF_COUNTER
         control_block->counters = performance_counters{}; // reset counters
 #endif
@@ -657,12 +976,13 @@ namespace emr {
         next = cur->next;
         if (cur->stamp <= tail_stamp)
         {
-          cur->delete_self();
+          reclaim_node(cur);
           ++cnt;
         }
         else
           break;
       }
+      flush_reclaimable_nodes();
 
       first_retired_node = cur;
       if (cur == nullptr)
@@ -670,7 +990,8 @@ namespace emr {
       number_of_retired_nodes -= cnt;
     }
 
-    void process_global_nodes()
+    // Returns true if all nodes could be reclaimed.
+    bool process_global_nodes()
     {
       auto tail_stamp = queue.tail_stamp();
       auto cur_chunk = queue.steal_global_retired_nodes();
@@ -684,10 +1005,11 @@ namespace emr {
         number_of_retired_nodes = 0;
       }
       if (cur_chunk == nullptr)
-        return;
+        return true;
 
       stamp_t lowest_stamp;
-      auto process_chunk_nodes = [tail_stamp, &lowest_stamp](deletable_object_with_stamp* chunk)
+      // tail_stamp is captured by reference, since it gets updated before we restart
+      auto process_chunk_nodes = [this, &tail_stamp, &lowest_stamp](deletable_object_with_stamp* chunk)
       {
         auto cur = chunk;
         while (cur)
@@ -696,7 +1018,7 @@ namespace emr {
           {
             lowest_stamp = std::min(lowest_stamp, cur->stamp);
             auto next = cur->next;
-            cur->delete_self();
+            reclaim_node(cur);
             cur = next;
           }
           else
@@ -724,6 +1046,7 @@ namespace emr {
       }
 
       *prev_remaining_chunk = nullptr;
+      flush_reclaimable_nodes();
       if (first_remaining_chunk)
       {
         auto new_tail_stamp = queue.tail_stamp();
@@ -733,11 +1056,83 @@ namespace emr {
           tail_stamp = new_tail_stamp;
           goto restart;
         }
+        else if (queue.evict_cached_tails())
+        {
+          // an idle thread with a cached region held back the tail stamp
+          cur_chunk = first_remaining_chunk;
+          tail_stamp = queue.tail_stamp();
+          goto restart;
+        }
         else
         {
           assert(last_remaining_chunk != nullptr);
-          queue.add_to_global_retired_nodes(first_remaining_chunk, last_remaining_chunk);
+          queue.add_to_global_retired_nodes(first_remaining_chunk, last_remaining_chunk, global_shard);
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Processes the chunks of one shard of the global retire-list, but reclaims at most
+    // global_slice_size nodes; the next call continues with the next shard.
+    void process_global_nodes_slice()
+    {
+      const auto idx = global_slice_cursor++;
+      auto cur_chunk = queue.steal_global_retired_nodes(idx);
+      if (cur_chunk == nullptr)
+        return;
+
+      const auto tail_stamp = queue.tail_stamp();
+      std::size_t budget = global_slice_size;
+      deletable_object_with_stamp* first_remaining_chunk = nullptr;
+      deletable_object_with_stamp* last_remaining_chunk = nullptr;
+      deletable_object_with_stamp** prev_remaining_chunk = &first_remaining_chunk;
+      while (cur_chunk)
+      {
+        auto next_chunk = cur_chunk->next_chunk;
+        auto cur = cur_chunk;
+        while (cur != nullptr && budget > 0 && cur->stamp <= tail_stamp)
+        {
+          auto next = cur->next;
+          reclaim_node(cur);
+          cur = next;
+          --budget;
         }
+
+        if (cur)
+        {
+          *prev_remaining_chunk = cur;
+          last_remaining_chunk = cur;
+          prev_remaining_chunk = &cur->next_chunk;
+        }
+        cur_chunk = next_chunk;
+      }
+
+      *prev_remaining_chunk = nullptr;
+      flush_reclaimable_nodes();
+      if (first_remaining_chunk)
+        queue.add_to_global_retired_nodes(first_remaining_chunk, last_remaining_chunk, idx);
+    }
+
+    void reclaim_node(deletable_object_with_stamp* p)
+    {
+      budget_counter.released();
+      if (background_reclamation::is_enabled())
+      {
+        p->next = reclaimable_nodes;
+        reclaimable_nodes = p;
+      }
+      else
+        p->delete_self();
+    }
+
+    // Hands over the collected nodes to the background thread.
+    void flush_reclaimable_nodes()
+    {
+      if (reclaimable_nodes != nullptr)
+      {
+        background_reclamation::submit(new deferred_deletion_batch(reclaimable_nodes));
+        reclaimable_nodes = nullptr;
       }
     }
 
@@ -749,14 +1144,30 @@ namespace emr {
     // when it leaves it's critical region. If there are more nodes in the
     // list, then the whole list will be added to the global retire-list.
     static const std::size_t max_remaining_retired_nodes = 20;
+    // The max. number of nodes from the global retire-list a thread reclaims
+    // when it leaves its critical region.
+    static const std::size_t global_slice_size = 64;
 
+    thread_order_queue* shard = nullptr;
     thread_control_block* control_block = nullptr;
     unsigned region_entries = 0;
+    // the number of regions we left without removing our control block from the queue
+    unsigned cached_regions = 0;
+    bool region_cached = false;
     std::size_t number_of_retired_nodes = 0;
+    memory_budget::thread_counter budget_counter;
+
+    // the shard of the global retire-list our remaining nodes are added to,
+    // and the shard we process next when we leave our region
+    unsigned global_shard = queue.select_global_retired_nodes_shard();
+    unsigned global_slice_cursor = global_shard;
 
     deletable_object_with_stamp* first_retired_node = nullptr;
     deletable_object_with_stamp** prev_retired_node = &first_retired_node;
 
+    // nodes that can be reclaimed, but are deleted by the background thread
+    deletable_object_with_stamp* reclaimable_nodes = nullptr;
+
     friend class stamp_it;
     ALLOCATION_COUNTER(stamp_it);
   };
@@ -771,6 +1182,27 @@ namespace emr {
       local_thread_data().leave_region();
   }
 
+  inline void stamp_it::synchronize()
+  {
+    local_thread_data().synchronize();
+  }
+
+  inline bool stamp_it::try_flush()
+  {
+    return local_thread_data().try_flush();
+  }
+
+  template <class Func>
+  void stamp_it::retire(Func&& f)
+  {
+    auto node = detail::deferred_callback<deletable_object_with_stamp>::create(std::forward<Func>(f));
+    auto& data = local_thread_data();
+    // leaving the region takes care of processing the retired nodes
+    data.enter_region();
+    data.add_retired_node(node);
+    data.leave_region();
+  }
+
   template <class T, class MarkedPtr>
   stamp_it::guard_ptr<T, MarkedPtr>::guard_ptr(const MarkedPtr& p) noexcept :
     base(p)
@@ -882,14 +1314,60 @@ namespace emr {
     return local_thread_data;
   }
 
-  SELECT_ANY stamp_it::thread_order_queue stamp_it::queue;
+  inline void stamp_it::set_number_of_shards(unsigned n)
+  {
+    queue.set_number_of_shards(n);
+  }
+
+  inline unsigned stamp_it::number_of_shards()
+  {
+    return queue.number_of_shards();
+  }
+
+  inline void stamp_it::enable_lazy_region_exit(unsigned max_cached_regions)
+  {
+    lazy_exit_regions.store(max_cached_regions, std::memory_order_relaxed);
+  }
+
+  inline void stamp_it::disable_lazy_region_exit()
+  {
+    lazy_exit_regions.store(0, std::memory_order_relaxed);
+  }
+
+  inline unsigned stamp_it::max_cached_regions()
+  {
+    return lazy_exit_regions.load(std::memory_order_relaxed);
+  }
+
+  SELECT_ANY stamp_it::sharded_thread_order_queue stamp_it::queue;
+  SELECT_ANY std::atomic<unsigned> stamp_it::lazy_exit_regions;
 
 #ifdef WITH_PERF_COUNTER
   inline stamp_it::performance_counters stamp_it::get_performance_counters()
   {
     performance_counters result{};
-    std::for_each(queue.global_thread_block_list.begin(),
-                  queue.global_thread_block_list.end(),
+    for (unsigned i = 0; i < max_shards; ++i)
+    {
+      auto cnt = get_performance_counters(i);
+      result.push_calls += cnt.push_calls;
+      result.push_iterations += cnt.push_iterations;
+      result.remove_calls += cnt.remove_calls;
+      result.remove_prev_iterations += cnt.remove_prev_iterations;
+      result.remove_next_iterations += cnt.remove_next_iterations;
+      result.lazy_region_exits += cnt.lazy_region_exits;
+    }
+    return result;
+  }
+
+  inline stamp_it::performance_counters stamp_it::get_performance_counters(unsigned shard)
+  {
+    performance_counters result{};
+    auto q = queue.get_shard(shard);
+    if (q == nullptr)
+      return result;
+
+    std::for_each(q->global_thread_block_list.begin(),
+                  q->global_thread_block_list.end(),
                   [&result](const auto& block)
                   {
                     result.push_calls += block.counters.push_calls;
@@ -897,6 +1375,7 @@ namespace emr {
                     result.remove_calls += block.counters.remove_calls;
                     result.remove_prev_iterations += block.counters.remove_prev_iterations;
                     result.remove_next_iterations += block.counters.remove_next_iterations;
+                    result.lazy_region_exits += block.counters.lazy_region_exits;
                   });
 
     return result;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "emr/acquire_guard.hpp"
+#include "emr/guard_array.hpp"
 
 #include "emr/detail/backoff.hpp"
 
@@ -47,8 +48,10 @@ private:
   {
     concurrent_ptr* prev;
     marked_ptr next;
-    guard_ptr cur;
-    guard_ptr save;
+    // cur and save are rotated on every step, so we reserve their resources once per operation
+    guard_array<guard_ptr, 2> guards;
+    guard_ptr& cur = guards[0];
+    guard_ptr& save = guards[1];
   };
   bool find(Key key, concurrent_ptr& head, find_info& info, detail::backoff& backoff);
 };
@@ -117,7 +120,7 @@ retry:
         return ckey == key;
 
       info.prev = &info.cur->next;
-      info.save = std::move(info.cur);
+      info.save.swap(info.cur);
     }
   }
 }
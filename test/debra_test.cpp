@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
+
 namespace {
 
 using Reclaimer = emr::debra<0>;
@@ -68,6 +71,26 @@ TEST_F(Debra, reclaim_releases_ownership_and_the_object_gets_deleted_when_advanc
   EXPECT_EQ(nullptr, foo);
 }
 
+TEST_F(Debra, synchronize_deletes_all_retired_objects)
+{
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_NE(nullptr, foo);
+  Reclaimer::synchronize();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Debra, retired_callback_is_called_by_synchronize)
+{
+  bool called = false;
+  Reclaimer::retire([&called]() { called = true; });
+  EXPECT_FALSE(called);
+  Reclaimer::synchronize();
+  EXPECT_TRUE(called);
+}
+
 TEST_F(Debra, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it)
 {
   concurrent_ptr<Foo>::guard_ptr gp(mp);
@@ -118,4 +141,71 @@ TEST_F(Debra, move_assignment_moves_ownership_and_resets_source_object)
   wrap_around_epochs();
   EXPECT_EQ(nullptr, foo);
 }
+
+using DebraPlus = emr::debra_plus<0, 1>;
+
+struct Bar : DebraPlus::enable_concurrent_ptr<Bar>
+{
+  Bar** instance;
+  Bar(Bar** instance) : instance(instance) {}
+  virtual ~Bar() { if (instance) *instance = nullptr; }
+};
+
+void update_debra_plus_epoch()
+{
+  Bar dummy(nullptr);
+  DebraPlus::concurrent_ptr<Bar>::guard_ptr gp(&dummy);
+}
+
+TEST(DebraPlus, restartable_calls_f_once_if_the_thread_is_not_neutralized)
+{
+  int calls = 0;
+  DebraPlus::restartable([&]() { ++calls; });
+  EXPECT_EQ(1, calls);
+}
+
+TEST(DebraPlus, stalled_thread_gets_neutralized_so_objects_can_be_reclaimed)
+{
+  DebraPlus::concurrent_ptr<Bar> obj;
+  obj.store(new Bar(nullptr));
+
+  std::atomic<int> attempts{0};
+  std::atomic<bool> stalled{false};
+  std::atomic<bool> done{false};
+  std::thread laggard([&]()
+  {
+    DebraPlus::restartable([&]()
+    {
+      if (++attempts > 1)
+        return; // we have been neutralized
+      // the operation runs inside a critical region, so obj is protected without a guard_ptr
+      stalled = obj.load(std::memory_order_acquire) != nullptr;
+      while (!done.load())
+        ;
+    });
+  });
+  while (!stalled.load())
+    ;
+
+  auto neutralizations = DebraPlus::number_of_neutralizations();
+
+  Bar* bar = new Bar(&bar);
+  DebraPlus::concurrent_ptr<Bar>::guard_ptr gp(bar);
+  gp.reclaim();
+  for (int i = 0; i < 1000 && bar != nullptr; ++i)
+  {
+    update_debra_plus_epoch();
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(nullptr, bar);
+
+  done = true;
+  laggard.join();
+  EXPECT_EQ(2, attempts.load());
+  EXPECT_EQ(neutralizations + 1, DebraPlus::number_of_neutralizations());
+
+  DebraPlus::concurrent_ptr<Bar>::guard_ptr last(obj.load());
+  obj.store(nullptr);
+  last.reclaim();
+}
 }
@@ -2,6 +2,13 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <thread>
+#include <vector>
+
 namespace {
 
 using Reclaimer = emr::epoch_based<0>;
@@ -71,6 +78,156 @@ TEST_F(EpochBased, reclaim_releases_ownership_and_the_object_gets_deleted_when_a
   EXPECT_EQ(nullptr, gp.get());
 }
 
+TEST_F(EpochBased, reclaim_with_background_reclamation_deletes_object_in_background_thread)
+{
+  Reclaimer::background_reclamation::enable();
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  wrap_around_epochs();
+  Reclaimer::background_reclamation::disable();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(EpochBased, incremental_reclamation_deletes_at_most_max_nodes_per_operation)
+{
+  // make sure there are no retired nodes left from previous tests
+  wrap_around_epochs();
+  wrap_around_epochs();
+
+  Reclaimer::incremental_reclamation::enable(1);
+  Foo* objects[3];
+  {
+    // stay inside the critical region, so all objects are retired in the same epoch
+    Foo dummy(nullptr);
+    concurrent_ptr<Foo>::guard_ptr outer(&dummy);
+    for (auto& obj : objects)
+    {
+      obj = new Foo(&obj);
+      concurrent_ptr<Foo>::guard_ptr gp(obj);
+      gp.reclaim();
+    }
+  }
+  auto deleted = [&objects]() { return std::count(std::begin(objects), std::end(objects), nullptr); };
+
+  wrap_around_epochs();
+  EXPECT_EQ(1, deleted());
+  update_epoch();
+  EXPECT_EQ(2, deleted());
+  update_epoch();
+  EXPECT_EQ(3, deleted());
+  Reclaimer::incremental_reclamation::disable();
+}
+
+TEST_F(EpochBased, nodes_of_terminated_thread_are_adopted_in_bounded_chunks)
+{
+  std::vector<Foo*> objects(250);
+  std::thread([this, &objects]()
+  {
+    // stay inside the critical region, so all objects are retired in the same epoch
+    Foo dummy(nullptr);
+    concurrent_ptr<Foo>::guard_ptr outer(&dummy);
+    for (auto& obj : objects)
+    {
+      obj = new Foo(&obj);
+      concurrent_ptr<Foo>::guard_ptr gp(obj);
+      gp.reclaim();
+    }
+  }).join();
+
+  auto deleted = [&objects]() { return std::count(objects.begin(), objects.end(), nullptr); };
+  for (int i = 0; i < 20 && deleted() < 250; ++i)
+  {
+    auto before = deleted();
+    update_epoch();
+    EXPECT_LE(deleted() - before, 100);
+  }
+  EXPECT_EQ(250, deleted());
+}
+
+TEST_F(EpochBased, all_old_retire_lists_are_reclaimed_at_once_when_thread_observes_a_new_epoch)
+{
+  Foo* objects[2];
+  std::atomic<int> step(0);
+  long deleted_after_first_update = 0;
+  std::thread thread([&]()
+  {
+    // every reclaim operation is performed in a new epoch
+    for (auto& obj : objects)
+    {
+      obj = new Foo(&obj);
+      concurrent_ptr<Foo>::guard_ptr gp(obj);
+      gp.reclaim();
+    }
+    step.store(1);
+    while (step.load() != 2)
+      std::this_thread::yield();
+
+    update_epoch();
+    deleted_after_first_update = std::count(std::begin(objects), std::end(objects), nullptr);
+  });
+
+  while (step.load() != 1)
+    std::this_thread::yield();
+  // the other thread is not inside a critical region, so we can advance the epoch arbitrarily
+  wrap_around_epochs();
+  wrap_around_epochs();
+  step.store(2);
+  thread.join();
+
+  EXPECT_EQ(2, deleted_after_first_update);
+}
+
+TEST_F(EpochBased, synchronize_deletes_all_retired_objects)
+{
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_NE(nullptr, foo);
+  Reclaimer::synchronize();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(EpochBased, try_flush_returns_true_once_all_retired_objects_have_been_deleted)
+{
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  // every call advances the epoch once
+  EXPECT_FALSE(Reclaimer::try_flush());
+  EXPECT_FALSE(Reclaimer::try_flush());
+  EXPECT_TRUE(Reclaimer::try_flush());
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(EpochBased, retired_callbacks_are_called_once_the_epoch_has_been_advanced_sufficiently)
+{
+  int calls = 0;
+  std::array<int, 32> large_capture{};
+  large_capture[0] = 1;
+  // the first callback is stored inside the node, the second one is too large and gets allocated separately
+  Reclaimer::retire([&calls]() { ++calls; });
+  Reclaimer::retire([&calls, large_capture]() { calls += large_capture[0]; });
+  EXPECT_EQ(0, calls);
+  Reclaimer::synchronize();
+  EXPECT_EQ(2, calls);
+}
+
+TEST_F(EpochBased, exceeding_the_memory_budget_switches_to_aggressive_mode_until_the_nodes_are_reclaimed)
+{
+  static std::vector<bool> notifications;
+  Reclaimer::synchronize();
+  Reclaimer::memory_budget::enable(2, [](bool aggressive, std::size_t) { notifications.push_back(aggressive); });
+  for (int i = 0; i < 3; ++i)
+    Reclaimer::retire([]() {});
+  EXPECT_TRUE(Reclaimer::memory_budget::is_aggressive());
+  Reclaimer::synchronize();
+  EXPECT_FALSE(Reclaimer::memory_budget::is_aggressive());
+  Reclaimer::memory_budget::disable();
+  EXPECT_EQ((std::vector<bool>{true, false}), notifications);
+}
+
 TEST_F(EpochBased, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it)
 {
   concurrent_ptr<Foo>::guard_ptr gp(mp);
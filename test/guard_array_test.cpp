@@ -0,0 +1,82 @@
+#include <emr/lock_free_ref_count.hpp>
+#include <emr/hazard_pointer.hpp>
+#include <emr/hazard_eras.hpp>
+#include <emr/epoch_based.hpp>
+#include <emr/stamp_it.hpp>
+#include <emr/guard_array.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <typename Reclaimer>
+struct GuardArray : testing::Test
+{
+  struct Foo : Reclaimer::template enable_concurrent_ptr<Foo>
+  {
+    Foo** instance;
+    Foo(Foo** instance) : instance(instance) {}
+    virtual ~Foo() { *instance = nullptr; }
+  };
+
+  using concurrent_ptr = typename Reclaimer::template concurrent_ptr<Foo>;
+  using guard_ptr = typename concurrent_ptr::guard_ptr;
+};
+
+using Reclaimers = ::testing::Types<
+    emr::lock_free_ref_count<>,
+    emr::hazard_pointer<emr::static_hazard_pointer_policy<2>>,
+    emr::hazard_eras<2>,
+    emr::epoch_based<10>,
+    emr::stamp_it
+  >;
+TYPED_TEST_CASE(GuardArray, Reclaimers);
+
+TYPED_TEST(GuardArray, guards_can_be_acquired_reset_and_swapped)
+{
+  using Foo = typename TestFixture::Foo;
+  Foo* foo1 = new Foo(&foo1);
+  Foo* foo2 = new Foo(&foo2);
+  typename TestFixture::concurrent_ptr p1(foo1);
+  typename TestFixture::concurrent_ptr p2(foo2);
+  {
+    typename TypeParam::region_guard rg{};
+    emr::guard_array<typename TestFixture::guard_ptr, 2> guards;
+    EXPECT_EQ(2u, guards.size());
+
+    guards[0].acquire(p1);
+    guards[1].acquire(p2);
+    EXPECT_EQ(foo1, guards[0].get());
+    EXPECT_EQ(foo2, guards[1].get());
+
+    guards[0].swap(guards[1]);
+    EXPECT_EQ(foo2, guards[0].get());
+    EXPECT_EQ(foo1, guards[1].get());
+
+    guards[1].reset();
+    EXPECT_EQ(nullptr, guards[1].get());
+    guards[1].acquire(p1);
+    EXPECT_EQ(foo1, guards[1].get());
+  }
+  delete foo1;
+  delete foo2;
+}
+
+TEST(GuardArray, hazard_pointers_remain_reserved_after_reset)
+{
+  using HP = emr::hazard_pointer<emr::static_hazard_pointer_policy<2>>;
+  struct Foo : HP::enable_concurrent_ptr<Foo> {};
+  using guard_ptr = HP::concurrent_ptr<Foo>::guard_ptr;
+
+  Foo foo;
+  {
+    emr::guard_array<guard_ptr, 2> guards;
+    guards[0].reset();
+    EXPECT_THROW(guard_ptr{&foo}, emr::bad_hazard_pointer_alloc);
+  }
+  // the hazard pointers are released again once the array is destroyed.
+  guard_ptr g1{&foo};
+  guard_ptr g2{&foo};
+}
+
+}
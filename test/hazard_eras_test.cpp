@@ -0,0 +1,174 @@
+#include <emr/hazard_eras.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+struct HazardEras : ::testing::Test
+{
+  // we are using A = B = 0 to enforce the immediate reclamation of nodes.
+  using HE = emr::hazard_eras<2, 0, 0>;
+
+  struct Foo : HE::enable_concurrent_ptr<Foo, 2>
+  {
+    Foo** instance;
+    Foo(Foo** instance) : instance(instance) {}
+    virtual ~Foo() { *instance = nullptr; }
+  };
+
+  using concurrent_ptr = HE::concurrent_ptr<Foo>;
+  using marked_ptr = concurrent_ptr::marked_ptr;
+  using guard_ptr = concurrent_ptr::guard_ptr;
+
+  Foo* foo = new Foo(&foo);
+  marked_ptr mp = marked_ptr(foo, 3);
+
+  void TearDown() override
+  {
+    // There might be some retired nodes remaining from a testcase that need to be reclaimed.
+    HE::synchronize();
+  }
+};
+
+TEST_F(HazardEras, mark_returns_the_same_mark_as_the_original_marked_ptr)
+{
+  guard_ptr gp(mp);
+  EXPECT_EQ(mp.mark(), gp.mark());
+}
+
+TEST_F(HazardEras, acquire_guard_acquires_pointer)
+{
+  concurrent_ptr foo_ptr(mp);
+  guard_ptr gp = emr::acquire_guard(foo_ptr);
+  EXPECT_EQ(mp, gp);
+}
+
+TEST_F(HazardEras, additional_acquire_calls_do_not_lead_to_overallocation_of_slots)
+{
+  concurrent_ptr foo_ptr(mp);
+  guard_ptr gp1, gp2;
+  gp1.acquire(foo_ptr);
+  gp1.acquire(foo_ptr);
+  gp2.acquire(foo_ptr);
+  gp1.acquire(foo_ptr);
+}
+
+TEST_F(HazardEras, acquire_if_equal_returns_true_and_acquires_pointer_when_values_are_equal)
+{
+  concurrent_ptr foo_ptr(mp);
+  guard_ptr gp;
+  EXPECT_TRUE(gp.acquire_if_equal(foo_ptr, mp));
+  EXPECT_EQ(mp, gp);
+}
+
+TEST_F(HazardEras, acquire_if_equal_returns_false_and_resets_guard_when_values_are_not_equal)
+{
+  concurrent_ptr foo_ptr(mp);
+  guard_ptr gp;
+  Foo* other = new Foo(&other);
+  std::unique_ptr<Foo> other_ptr(other);
+  EXPECT_FALSE(gp.acquire_if_equal(foo_ptr, other));
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(HazardEras, throws_bad_hazard_era_alloc_when_slots_are_exceeded)
+{
+  guard_ptr gp1{mp};
+  guard_ptr gp2{mp};
+  EXPECT_THROW(
+    guard_ptr gp3{mp},
+    emr::bad_hazard_era_alloc
+  );
+}
+
+TEST_F(HazardEras, reclaim_releases_ownership_and_deletes_object_because_no_era_protects_it)
+{
+  guard_ptr gp(mp);
+  gp.reclaim();
+  EXPECT_EQ(nullptr, foo);
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(HazardEras, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it)
+{
+  guard_ptr gp(mp);
+  guard_ptr gp2(mp);
+  gp.reclaim();
+  EXPECT_NE(nullptr, foo);
+}
+
+TEST_F(HazardEras, try_flush_returns_true_once_the_retired_object_is_no_longer_protected)
+{
+  guard_ptr gp(mp);
+  guard_ptr gp2(mp);
+  gp.reclaim();
+  EXPECT_FALSE(HE::try_flush());
+  EXPECT_NE(nullptr, foo);
+  gp2.reset();
+  EXPECT_TRUE(HE::try_flush());
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(HazardEras, retired_callback_is_not_called_while_a_previously_published_era_is_protected)
+{
+  bool called = false;
+  guard_ptr gp(mp);
+  HE::retire([&called]() { called = true; });
+  EXPECT_FALSE(HE::try_flush());
+  EXPECT_FALSE(called);
+  gp.reset();
+  EXPECT_TRUE(HE::try_flush());
+  EXPECT_TRUE(called);
+}
+
+TEST_F(HazardEras, copy_of_guard_protects_the_object_even_after_it_was_retired)
+{
+  guard_ptr gp(mp);
+  guard_ptr gp2(mp);
+  gp.reclaim();
+
+  // further retirements advance the era clock
+  Foo* other = new Foo(&other);
+  guard_ptr{other}.reclaim();
+  EXPECT_EQ(nullptr, other);
+
+  guard_ptr gp3(gp2);
+  gp2.reset();
+  Foo* dummy = new Foo(&dummy);
+  guard_ptr{dummy}.reclaim();
+  EXPECT_NE(nullptr, foo);
+
+  gp3.reset();
+  dummy = new Foo(&dummy);
+  guard_ptr{dummy}.reclaim();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(HazardEras, object_allocated_after_the_published_era_is_reclaimed)
+{
+  guard_ptr gp(mp);
+
+  // advance the era clock so that the next object is born after the era published by gp.
+  Foo* dummy = new Foo(&dummy);
+  guard_ptr{dummy}.reclaim();
+
+  Foo* other = new Foo(&other);
+  guard_ptr{other}.reclaim();
+  EXPECT_EQ(nullptr, other);
+  EXPECT_NE(nullptr, foo);
+  gp.reset();
+  delete foo;
+}
+
+TEST_F(HazardEras, move_assignment_moves_ownership_and_resets_source_object)
+{
+  guard_ptr gp(mp);
+  guard_ptr gp2{};
+  gp2 = std::move(gp);
+  gp2.reclaim();
+  EXPECT_EQ(nullptr, gp.get());
+  EXPECT_EQ(nullptr, foo);
+}
+}
@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
 namespace {
 
 struct my_static_hazard_pointer_policy : emr::static_hazard_pointer_policy<2>
@@ -18,6 +20,11 @@ struct my_dynamic_hazard_pointer_policy : emr::dynamic_hazard_pointer_policy<2>
   static constexpr size_t retired_nodes_threshold() { return 0; }
 };
 
+struct my_asymmetric_dynamic_hazard_pointer_policy : emr::asymmetric_dynamic_hazard_pointer_policy<2>
+{
+  static constexpr size_t retired_nodes_threshold() { return 0; }
+};
+
 template <typename Policy>
 struct HazardPointer : ::testing::Test
 {
@@ -51,17 +58,14 @@ struct HazardPointer : ::testing::Test
   void TearDown() override
   {
     // There might be some retired nodes remaining from a testcase that need to be reclaimed.
-    // In order to do so we create a guard for a dummy object and mark it for reclamation.
-    // This triggers reclamation of all the objects in the retired_list.
-    Foo* dummy = new Foo(&dummy);
-    typename concurrent_ptr<Foo>::guard_ptr gp(dummy);
-    gp.reclaim();
+    HP::synchronize();
   }
 };
 
 using Policies = ::testing::Types<
     my_static_hazard_pointer_policy,
-    my_dynamic_hazard_pointer_policy
+    my_dynamic_hazard_pointer_policy,
+    my_asymmetric_dynamic_hazard_pointer_policy
   >;
 TYPED_TEST_CASE(HazardPointer, Policies);
 
@@ -119,7 +123,7 @@ TYPED_TEST(HazardPointer, acquire_if_equal_returns_false_and_resets_guard_when_v
 }
 TYPED_TEST(HazardPointer, static_policy_throws_bad_hazard_pointer_when_HP_pool_is_exceeded)
 {
-  if (std::is_same<TypeParam , my_dynamic_hazard_pointer_policy>::value)
+  if (!std::is_same<TypeParam , my_static_hazard_pointer_policy>::value)
     return;
 
   using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
@@ -157,6 +161,61 @@ TYPED_TEST(HazardPointer, object_cannot_be_reclaimed_as_long_as_another_guard_pr
   EXPECT_NE(nullptr, this->foo);
 }
 
+TYPED_TEST(HazardPointer, try_flush_returns_true_once_the_retired_object_is_no_longer_protected)
+{
+  using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
+  using HP = typename TestFixture::HP;
+  guard_ptr gp(this->mp);
+  guard_ptr gp2(this->mp);
+  gp.reclaim();
+  EXPECT_FALSE(HP::try_flush());
+  EXPECT_NE(nullptr, this->foo);
+  gp2.reset();
+  EXPECT_TRUE(HP::try_flush());
+  EXPECT_EQ(nullptr, this->foo);
+}
+
+TYPED_TEST(HazardPointer, retired_callback_is_not_called_while_a_pointer_protected_at_retire_time_is_still_protected)
+{
+  using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
+  using HP = typename TestFixture::HP;
+  bool called = false;
+  guard_ptr gp(this->mp);
+  HP::retire([&called]() { called = true; });
+  EXPECT_FALSE(HP::try_flush());
+  EXPECT_FALSE(called);
+  gp.reset();
+  HP::synchronize();
+  EXPECT_TRUE(called);
+}
+
+TYPED_TEST(HazardPointer, retired_callback_is_called_once_the_hazard_pointers_protecting_an_object_at_retire_time_have_changed)
+{
+  using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
+  using HP = typename TestFixture::HP;
+  bool called = false;
+  guard_ptr gp(this->mp);
+  HP::retire([&called]() { called = true; });
+  EXPECT_FALSE(HP::try_flush());
+  EXPECT_FALSE(called);
+  // the object remains protected all the time, but by a different hazard pointer
+  guard_ptr gp2(this->mp);
+  gp.reset();
+  EXPECT_TRUE(HP::try_flush());
+  EXPECT_TRUE(called);
+}
+
+TYPED_TEST(HazardPointer, scans_record_the_retire_threshold_of_the_scanning_thread)
+{
+  using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
+  using HP = typename TestFixture::HP;
+  guard_ptr gp(this->mp);
+  gp.reset();
+  auto updates = HP::get_retire_threshold_statistics().updates;
+  HP::try_flush();
+  EXPECT_EQ(updates + 1, HP::get_retire_threshold_statistics().updates);
+}
+
 TYPED_TEST(HazardPointer, copy_constructor_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed)
 {
   using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
@@ -250,4 +309,107 @@ TYPED_TEST(HazardPointer, dynamic_policy_can_protect_more_than_K_objects)
   for (size_t i = 0; i < count; ++i)
     EXPECT_EQ(nullptr, foos[i]);
 }
+
+TYPED_TEST(HazardPointer, dynamic_policy_removes_hazard_pointer_blocks_that_are_no_longer_needed)
+{
+  if (std::is_same<TypeParam , my_static_hazard_pointer_policy>::value)
+    return;
+
+  using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
+
+  {
+    std::vector<guard_ptr> guards(100);
+    for (auto& guard : guards)
+      guard = guard_ptr(this->mp);
+    EXPECT_LE(100u, TypeParam::number_of_active_hazard_pointers());
+  }
+
+  // after a sufficient number of operations that only use a single hazard pointer,
+  // all additional blocks are removed again.
+  for (size_t i = 0; i < 4096; ++i)
+    guard_ptr{this->mp};
+
+  const size_t K = TypeParam::K;
+  EXPECT_EQ(K, TypeParam::number_of_active_hazard_pointers());
+
+  // removed blocks can be reused
+  {
+    std::vector<guard_ptr> guards(100);
+    for (auto& guard : guards)
+      guard = guard_ptr(this->mp);
+    EXPECT_LE(100u, TypeParam::number_of_active_hazard_pointers());
+  }
+  delete this->foo;
+}
+TYPED_TEST(HazardPointer, background_thread_reclaims_retired_object_once_it_is_no_longer_protected)
+{
+  using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
+  using background_reclamation = typename TestFixture::HP::background_reclamation;
+
+  background_reclamation::enable();
+  guard_ptr gp(this->mp);
+  guard_ptr gp2(this->mp);
+  gp.reclaim();
+  EXPECT_NE(nullptr, this->foo);
+
+  gp2.reset();
+  // disable waits until all handed over nodes are reclaimed
+  background_reclamation::disable();
+  EXPECT_EQ(nullptr, this->foo);
+}
+
+TYPED_TEST(HazardPointer, nodes_abandoned_by_terminated_thread_are_adopted_by_subsequent_scan)
+{
+  using Foo = typename TestFixture::Foo;
+  using guard_ptr = typename TestFixture::template concurrent_ptr<Foo>::guard_ptr;
+
+  guard_ptr gp(this->mp);
+  std::thread([this]()
+  {
+    guard_ptr gp2(this->mp);
+    gp2.reclaim();
+  }).join();
+  EXPECT_NE(nullptr, this->foo);
+
+  gp.reset();
+  // retiring some other object triggers a scan that adopts the abandoned node
+  Foo* dummy = new Foo(&dummy);
+  guard_ptr(dummy).reclaim();
+  EXPECT_EQ(nullptr, this->foo);
+}
+
+struct adaptive_threshold_test_policy
+{
+  static constexpr size_t min_retired_nodes = 10;
+  static constexpr size_t max_retired_nodes = 1000;
+  static size_t retired_nodes_threshold() { return 100; }
+  static size_t number_of_active_hazard_pointers() { return 4; }
+};
+
+TEST(AdaptiveRetireThreshold, increases_threshold_when_scan_yield_is_low_and_respects_memory_budget)
+{
+  emr::adaptive_retire_threshold<adaptive_threshold_test_policy> threshold;
+  EXPECT_EQ(100u, threshold.get());
+
+  threshold.update(100, 10);
+  EXPECT_EQ(200u, threshold.get());
+
+  for (int i = 0; i < 10; ++i)
+    threshold.update(threshold.get(), 0);
+  EXPECT_EQ(1000u, threshold.get());
+}
+
+TEST(AdaptiveRetireThreshold, decreases_threshold_when_scan_yield_is_high_but_not_below_lower_bound)
+{
+  emr::adaptive_retire_threshold<adaptive_threshold_test_policy> threshold;
+  threshold.update(100, 100);
+  EXPECT_EQ(75u, threshold.get());
+
+  threshold.update(75, 50);
+  EXPECT_EQ(75u, threshold.get());
+
+  for (int i = 0; i < 20; ++i)
+    threshold.update(threshold.get(), threshold.get());
+  EXPECT_EQ(4u + 10u, threshold.get());
+}
 }
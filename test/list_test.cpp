@@ -1,5 +1,6 @@
 #include <emr/lock_free_ref_count.hpp>
 #include <emr/hazard_pointer.hpp>
+#include <emr/hazard_eras.hpp>
 #include <emr/epoch_based.hpp>
 #include <emr/new_epoch_based.hpp>
 #include <emr/quiescent_state_based.hpp>
@@ -18,7 +19,9 @@ struct List : testing::Test {};
 
 using Reclaimers = ::testing::Types<
     emr::lock_free_ref_count<>,
+    emr::lock_free_ref_count<false, 0, 0, 0, true>,
     emr::hazard_pointer<emr::static_hazard_pointer_policy<3>>,
+    emr::hazard_eras<3>,
     emr::epoch_based<10>,
     emr::new_epoch_based<10>,
     emr::quiescent_state_based,
@@ -128,4 +131,32 @@ TYPED_TEST(List, parallel_usage_with_same_values)
     thread.join();
 }
 
+TYPED_TEST(List, parallel_removal_of_the_last_element)
+{
+  using Reclaimer = TypeParam;
+  emr::list<int, TypeParam> list;
+  list.insert(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.push_back(std::thread([&list]
+    {
+      // all threads insert and unlink the same node at the end of the list
+      for (int j = 0; j < MaxIterations; ++j)
+      {
+        typename Reclaimer::region_guard critical_region{};
+        list.insert(1);
+        list.remove(1);
+        list.search(1);
+      }
+    }));
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_TRUE(list.search(0));
+  EXPECT_FALSE(list.search(1));
+}
+
 }
\ No newline at end of file
@@ -1,7 +1,11 @@
 #include <emr/lock_free_ref_count.hpp>
 
 #include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
 #include <thread>
+#include <vector>
 
 namespace {
 
@@ -127,4 +131,276 @@ TEST_F(LockFreeRefCount, parallel_allocation_and_deallocation_of_nodes)
   for (auto& thread : threads)
     thread.join();
 }
+
+TEST(LockFreeRefCountMagazines, nodes_freed_by_a_terminated_thread_get_reused_by_other_threads)
+{
+  using Reclaimer = emr::lock_free_ref_count<false, 8, 4>;
+  struct Dummy : Reclaimer::enable_concurrent_ptr<Dummy> {};
+
+  std::vector<Dummy*> freed;
+  std::thread([&freed]
+  {
+    for (int i = 0; i < 8; ++i)
+      freed.push_back(new Dummy);
+    for (auto node : freed)
+      delete node;
+  }).join();
+
+  Dummy* reused = nullptr;
+  std::thread([&reused] { reused = new Dummy; delete reused; }).join();
+  EXPECT_NE(freed.end(), std::find(freed.begin(), freed.end(), reused));
+}
+
+TEST(LockFreeRefCountMagazines, all_nodes_freed_by_a_terminated_thread_get_reused_by_another_thread)
+{
+  using Reclaimer = emr::lock_free_ref_count<false, 8, 4>;
+  struct Dummy : Reclaimer::enable_concurrent_ptr<Dummy> {};
+
+  // more than a few magazines, and the last one is only partially filled
+  const std::size_t NumberOfNodes = 8 * 12 + 3;
+  std::vector<Dummy*> freed;
+  std::thread([&freed, NumberOfNodes]
+  {
+    for (std::size_t i = 0; i < NumberOfNodes; ++i)
+      freed.push_back(new Dummy);
+    for (auto node : freed)
+      delete node;
+  }).join();
+
+  std::vector<Dummy*> reused;
+  std::thread([&reused, NumberOfNodes]
+  {
+    for (std::size_t i = 0; i < NumberOfNodes; ++i)
+      reused.push_back(new Dummy);
+    for (auto node : reused)
+      delete node;
+  }).join();
+
+  std::sort(freed.begin(), freed.end());
+  std::sort(reused.begin(), reused.end());
+  EXPECT_EQ(freed, reused);
+}
+
+TEST(LockFreeRefCountMagazines, parallel_allocation_and_deallocation_of_nodes)
+{
+  using Reclaimer = emr::lock_free_ref_count<false, 8, 4>;
+  struct Dummy : Reclaimer::enable_concurrent_ptr<Dummy> {};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 16; ++i)
+  {
+    threads.push_back(std::thread([]
+    {
+      const int MaxIterations = 10000;
+      std::vector<Dummy*> nodes;
+      for (int j = 0; j < MaxIterations; ++j)
+      {
+        // allocate and free bursts of nodes so full magazines are exchanged with the depot
+        for (int k = 0; k < 20; ++k)
+          nodes.push_back(new Dummy);
+        for (auto node : nodes)
+          delete node;
+        nodes.clear();
+
+        Reclaimer::concurrent_ptr<Dummy>::guard_ptr g(new Dummy);
+        g.reclaim();
+      }
+    }));
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+}
+
+TEST(LockFreeRefCountTrimming, free_nodes_beyond_the_watermark_are_returned_to_the_allocator)
+{
+  using Reclaimer = emr::lock_free_ref_count<false, 0, 0, 16>;
+  struct Dummy : Reclaimer::enable_concurrent_ptr<Dummy> {};
+
+  auto trimmed = Reclaimer::number_of_trimmed_nodes();
+  std::thread([]
+  {
+    std::vector<Dummy*> nodes;
+    for (int i = 0; i < 200; ++i)
+      nodes.push_back(new Dummy);
+    for (auto node : nodes)
+      delete node;
+  }).join();
+
+  // the first 16 nodes remain on the free list, no thread holds a guard that could delay the rest
+  EXPECT_EQ(200 - 16, Reclaimer::number_of_trimmed_nodes() - trimmed);
+}
+
+TEST(LockFreeRefCountTrimming, free_nodes_are_not_returned_while_other_threads_hold_guards)
+{
+  using Reclaimer = emr::lock_free_ref_count<false, 0, 0, 17>;
+  struct Dummy : Reclaimer::enable_concurrent_ptr<Dummy> {};
+
+  Reclaimer::concurrent_ptr<Dummy> root(new Dummy);
+  Reclaimer::concurrent_ptr<Dummy>::guard_ptr guard;
+  guard.acquire(root);
+
+  auto trimmed = Reclaimer::number_of_trimmed_nodes();
+  std::vector<Dummy*> freed;
+  std::thread([&freed]
+  {
+    for (int i = 0; i < 200; ++i)
+      freed.push_back(new Dummy);
+    for (auto node : freed)
+      delete node;
+  }).join();
+  EXPECT_EQ(trimmed, Reclaimer::number_of_trimmed_nodes());
+
+  // the nodes that could not be returned are still available for reuse
+  auto reused = new Dummy;
+  EXPECT_NE(freed.end(), std::find(freed.begin(), freed.end(), reused));
+  delete reused;
+
+  guard.reclaim();
+}
+
+TEST(LockFreeRefCountTrimming, parallel_acquire_and_reclamation_of_nodes)
+{
+  using Reclaimer = emr::lock_free_ref_count<false, 8, 4, 32>;
+  struct Dummy : Reclaimer::enable_concurrent_ptr<Dummy> {};
+
+  Reclaimer::concurrent_ptr<Dummy> root(new Dummy);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.push_back(std::thread([&root]
+    {
+      const int MaxIterations = 10000;
+      std::vector<Dummy*> nodes;
+      for (int j = 0; j < MaxIterations; ++j)
+      {
+        Reclaimer::concurrent_ptr<Dummy>::guard_ptr g;
+        g.acquire(root);
+
+        // exchange the root node from time to time, so other threads acquire nodes that get freed
+        if (j % 4 == 0)
+        {
+          Reclaimer::concurrent_ptr<Dummy>::marked_ptr expected(g);
+          auto node = new Dummy;
+          if (root.compare_exchange_strong(expected, node))
+            g.reclaim();
+          else
+            delete node;
+        }
+
+        for (int k = 0; k < 20; ++k)
+          nodes.push_back(new Dummy);
+        for (auto node : nodes)
+          delete node;
+        nodes.clear();
+      }
+    }));
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  Reclaimer::concurrent_ptr<Dummy>::guard_ptr g(root.load(std::memory_order_relaxed));
+  g.reclaim();
+  EXPECT_GT(Reclaimer::number_of_trimmed_nodes(), 0u);
+}
+
+using SplitReclaimer = emr::lock_free_ref_count<false, 0, 0, 0, true>;
+
+struct SplitFoo : SplitReclaimer::enable_concurrent_ptr<SplitFoo, 1>
+{
+  static std::atomic<int> instances;
+  SplitFoo() { ++instances; }
+  virtual ~SplitFoo() { --instances; }
+};
+std::atomic<int> SplitFoo::instances{0};
+
+using split_ptr = SplitReclaimer::concurrent_ptr<SplitFoo>;
+
+TEST(LockFreeRefCountSplit, acquire_takes_the_reference_from_the_batch_of_the_pointer)
+{
+  split_ptr ptr(new SplitFoo);
+  auto node = ptr.load().get();
+  auto refs = node->refs();
+
+  split_ptr::guard_ptr g;
+  g.acquire(ptr);
+  EXPECT_EQ(node, g.get());
+  EXPECT_EQ(refs, node->refs());
+
+  ptr.store(nullptr);
+  g.reclaim();
+  EXPECT_EQ(0, SplitFoo::instances);
+}
+
+TEST(LockFreeRefCountSplit, changing_only_the_mark_keeps_the_batch)
+{
+  split_ptr ptr(new SplitFoo);
+  auto node = ptr.load().get();
+  split_ptr::guard_ptr g;
+  g.acquire(ptr);
+  auto refs = node->refs();
+
+  split_ptr::marked_ptr expected(node);
+  EXPECT_TRUE(ptr.compare_exchange_strong(expected, split_ptr::marked_ptr(node, 1)));
+  EXPECT_EQ(refs, node->refs());
+  EXPECT_EQ(1u, ptr.load().mark());
+
+  ptr.store(nullptr);
+  g.reclaim();
+  EXPECT_EQ(0, SplitFoo::instances);
+}
+
+TEST(LockFreeRefCountSplit, node_is_destroyed_after_more_acquires_than_fit_in_a_batch)
+{
+  split_ptr ptr(new SplitFoo);
+  std::vector<split_ptr::guard_ptr> guards(40000);
+  for (auto& g : guards)
+    g.acquire(ptr);
+  for (auto& g : guards)
+    EXPECT_EQ(ptr.load().get(), g.get());
+
+  auto g = std::move(guards.back());
+  guards.clear();
+  ptr.store(nullptr);
+  EXPECT_EQ(1, SplitFoo::instances);
+  g.reclaim();
+  EXPECT_EQ(0, SplitFoo::instances);
+}
+
+TEST(LockFreeRefCountSplit, parallel_acquire_and_replacement_of_a_hot_node)
+{
+  split_ptr ptr(new SplitFoo);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.push_back(std::thread([&ptr, i]
+    {
+      const int MaxIterations = 20000;
+      for (int j = 0; j < MaxIterations; ++j)
+      {
+        split_ptr::guard_ptr g;
+        g.acquire(ptr);
+        if (i == 0 && j % 64 == 0)
+        {
+          split_ptr::marked_ptr expected(g);
+          auto node = new SplitFoo;
+          if (ptr.compare_exchange_strong(expected, node))
+            g.reclaim();
+          else
+            delete node;
+        }
+      }
+    }));
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  split_ptr::guard_ptr g;
+  g.acquire(ptr);
+  ptr.store(nullptr);
+  g.reclaim();
+  EXPECT_EQ(0, SplitFoo::instances);
+}
 }
@@ -28,6 +28,26 @@ TEST(marked_ptr, deref_works_correctly)
   EXPECT_EQ(43, f.x);
 }
 
+#if defined(WITH_UPPER_MARK_BITS) && UINTPTR_MAX > 0xFFFFFFFF
+TEST(marked_ptr, with_upper_bits_get_returns_correct_pointer_and_mark)
+{
+  alignas(8) Foo f;
+  const uintptr_t mark = (1 << 17) | (1 << 5) | 5;
+  emr::detail::marked_ptr<Foo, 18, 3> p(&f, mark);
+  EXPECT_EQ(&f, p.get());
+  EXPECT_EQ(mark, p.mark());
+}
+
+TEST(marked_ptr, with_upper_bits_marks_with_different_upper_bits_are_not_equal)
+{
+  alignas(8) Foo f;
+  emr::detail::marked_ptr<Foo, 18, 3> p1(&f, 1 << 3);
+  emr::detail::marked_ptr<Foo, 18, 3> p2(&f, 1 << 4);
+  EXPECT_NE(p1, p2);
+  EXPECT_EQ(p1.get(), p2.get());
+}
+#endif
+
 TEST(marked_ptr, reset_sets_ptr_to_null)
 {
   Foo f;
@@ -71,6 +71,39 @@ TEST_F(NewEpochBased, reclaim_releases_ownership_and_the_object_gets_deleted_whe
   EXPECT_EQ(nullptr, gp.get());
 }
 
+TEST_F(NewEpochBased, synchronize_deletes_all_retired_objects)
+{
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_NE(nullptr, foo);
+  Reclaimer::synchronize();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(NewEpochBased, retired_callback_is_called_by_synchronize)
+{
+  bool called = false;
+  Reclaimer::retire([&called]() { called = true; });
+  EXPECT_FALSE(called);
+  Reclaimer::synchronize();
+  EXPECT_TRUE(called);
+}
+
+TEST_F(NewEpochBased, try_flush_returns_true_once_all_retired_objects_have_been_deleted)
+{
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  // every call advances the epoch once
+  EXPECT_FALSE(Reclaimer::try_flush());
+  EXPECT_FALSE(Reclaimer::try_flush());
+  EXPECT_TRUE(Reclaimer::try_flush());
+  EXPECT_EQ(nullptr, foo);
+}
+
 TEST_F(NewEpochBased, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it)
 {
   concurrent_ptr<Foo>::guard_ptr gp(mp);
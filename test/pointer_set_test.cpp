@@ -0,0 +1,73 @@
+#include <emr/detail/pointer_set.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+struct Foo {
+  int x;
+};
+
+TEST(pointer_set, contains_returns_false_for_empty_set)
+{
+  Foo f;
+  emr::detail::pointer_set<Foo> set;
+  EXPECT_FALSE(set.contains(&f));
+  set.clear(10);
+  EXPECT_FALSE(set.contains(&f));
+}
+
+TEST(pointer_set, contains_inserted_pointers)
+{
+  Foo a, b, c;
+  emr::detail::pointer_set<Foo> set;
+  set.clear(2);
+  set.insert(&a);
+  set.insert(&b);
+  set.insert(&a);
+  EXPECT_TRUE(set.contains(&a));
+  EXPECT_TRUE(set.contains(&b));
+  EXPECT_FALSE(set.contains(&c));
+  EXPECT_EQ(2, set.get_size());
+}
+
+TEST(pointer_set, ignores_nullptr)
+{
+  emr::detail::pointer_set<Foo> set;
+  set.clear(1);
+  set.insert(nullptr);
+  EXPECT_EQ(0, set.get_size());
+  EXPECT_FALSE(set.contains(nullptr));
+}
+
+TEST(pointer_set, clear_removes_all_elements_and_keeps_capacity)
+{
+  Foo a;
+  emr::detail::pointer_set<Foo> set;
+  set.clear(100);
+  auto capacity = set.get_capacity();
+  set.insert(&a);
+  set.clear(50);
+  EXPECT_FALSE(set.contains(&a));
+  EXPECT_EQ(0, set.get_size());
+  EXPECT_EQ(capacity, set.get_capacity());
+}
+
+TEST(pointer_set, grows_when_more_elements_than_expected_are_inserted)
+{
+  std::vector<Foo> foos(1000);
+  emr::detail::pointer_set<Foo> set;
+  set.clear(1);
+  for (auto& f : foos)
+    set.insert(&f);
+
+  EXPECT_EQ(foos.size(), set.get_size());
+  for (auto& f : foos)
+    EXPECT_TRUE(set.contains(&f));
+  Foo other;
+  EXPECT_FALSE(set.contains(&other));
+}
+
+}
@@ -1,5 +1,6 @@
 #include <emr/lock_free_ref_count.hpp>
 #include <emr/hazard_pointer.hpp>
+#include <emr/hazard_eras.hpp>
 #include <emr/epoch_based.hpp>
 #include <emr/new_epoch_based.hpp>
 #include <emr/quiescent_state_based.hpp>
@@ -18,7 +19,9 @@ struct Queue : testing::Test {};
 
 using Reclaimers = ::testing::Types<
     emr::lock_free_ref_count<>,
+    emr::lock_free_ref_count<false, 0, 0, 0, true>,
     emr::hazard_pointer<emr::static_hazard_pointer_policy<2>>,
+    emr::hazard_eras<2>,
     emr::epoch_based<10>,
     emr::new_epoch_based<10>,
     emr::quiescent_state_based,
@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
+
 namespace {
 
 using Reclaimer = emr::quiescent_state_based;
@@ -66,6 +69,38 @@ TEST_F(QuiescentStateBased, reclaim_releases_ownership_and_the_object_gets_delet
   EXPECT_EQ(nullptr, gp.get());
 }
 
+TEST_F(QuiescentStateBased, synchronize_deletes_all_retired_objects)
+{
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_NE(nullptr, foo);
+  Reclaimer::synchronize();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(QuiescentStateBased, retired_callback_is_called_by_synchronize)
+{
+  bool called = false;
+  Reclaimer::retire([&called]() { called = true; });
+  EXPECT_FALSE(called);
+  Reclaimer::synchronize();
+  EXPECT_TRUE(called);
+}
+
+TEST_F(QuiescentStateBased, try_flush_returns_true_once_all_retired_objects_have_been_deleted)
+{
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  // leaving the region was already a quiescent state, and every call passes through another one
+  EXPECT_FALSE(Reclaimer::try_flush());
+  EXPECT_TRUE(Reclaimer::try_flush());
+  EXPECT_EQ(nullptr, foo);
+}
+
 TEST_F(QuiescentStateBased, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it)
 {
   concurrent_ptr<Foo>::guard_ptr gp(mp);
@@ -114,4 +149,57 @@ TEST_F(QuiescentStateBased, move_assignment_moves_ownership_and_resets_source_ob
   EXPECT_EQ(nullptr, gp.get());
   EXPECT_EQ(nullptr, foo);
 }
+
+TEST_F(QuiescentStateBased, offline_thread_does_not_prevent_objects_from_being_reclaimed)
+{
+  std::atomic<bool> offline{false};
+  std::atomic<bool> done{false};
+  std::thread idle_thread([&]()
+  {
+    update_epoch(); // registers the thread
+    Reclaimer::thread_offline();
+    offline = true;
+    while (!done.load())
+      std::this_thread::yield();
+    Reclaimer::thread_online();
+    update_epoch();
+  });
+  while (!offline.load())
+    std::this_thread::yield();
+
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  wrap_around_epochs();
+  EXPECT_EQ(nullptr, foo);
+
+  done = true;
+  idle_thread.join();
+}
+
+TEST_F(QuiescentStateBased, online_thread_prevents_objects_from_being_reclaimed)
+{
+  std::atomic<bool> online{false};
+  std::atomic<bool> done{false};
+  std::thread idle_thread([&]()
+  {
+    update_epoch(); // registers the thread
+    Reclaimer::thread_offline();
+    Reclaimer::thread_online();
+    online = true;
+    while (!done.load())
+      std::this_thread::yield();
+  });
+  while (!online.load())
+    std::this_thread::yield();
+
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  wrap_around_epochs();
+  EXPECT_NE(nullptr, foo);
+
+  done = true;
+  idle_thread.join();
+  wrap_around_epochs();
+  EXPECT_EQ(nullptr, foo);
+}
 }
@@ -0,0 +1,83 @@
+#include <emr/detail/reclamation_budget.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct test_reclaimer {};
+using budget = emr::detail::reclamation_budget<test_reclaimer>;
+
+std::vector<bool> notifications;
+
+struct ReclamationBudget : testing::Test
+{
+  void SetUp() override
+  {
+    notifications.clear();
+    budget::enable(100, [](bool aggressive, std::size_t) { notifications.push_back(aggressive); });
+  }
+
+  void TearDown() override
+  {
+    budget::add(-static_cast<std::ptrdiff_t>(budget::unreclaimed_nodes()));
+    budget::disable();
+  }
+};
+
+TEST_F(ReclamationBudget, thread_counter_publishes_its_changes_at_the_latest_when_it_gets_destroyed)
+{
+  {
+    budget::thread_counter counter;
+    counter.retired(3);
+    counter.released();
+    counter.flush();
+    EXPECT_EQ(2u, budget::unreclaimed_nodes());
+    counter.retired(2);
+  }
+  EXPECT_EQ(4u, budget::unreclaimed_nodes());
+}
+
+TEST_F(ReclamationBudget, aggressive_mode_is_entered_when_budget_is_exceeded_and_left_below_three_quarters)
+{
+  budget::thread_counter counter;
+  counter.retired(100);
+  counter.flush();
+  EXPECT_FALSE(budget::is_aggressive());
+  EXPECT_EQ(40u, budget::threshold(40));
+
+  counter.retired();
+  counter.flush();
+  EXPECT_TRUE(budget::is_aggressive());
+  EXPECT_EQ(0u, budget::threshold(40));
+
+  counter.released(26);
+  counter.flush();
+  EXPECT_TRUE(budget::is_aggressive());
+
+  counter.released();
+  counter.flush();
+  EXPECT_FALSE(budget::is_aggressive());
+  EXPECT_EQ((std::vector<bool>{true, false}), notifications);
+}
+
+TEST_F(ReclamationBudget, changes_of_concurrent_threads_are_summed_up)
+{
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.emplace_back([]()
+    {
+      budget::thread_counter counter;
+      for (int j = 0; j < 1000; ++j)
+        counter.retired();
+      for (int j = 0; j < 990; ++j)
+        counter.released();
+    });
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(40u, budget::unreclaimed_nodes());
+}
+
+}
@@ -0,0 +1,127 @@
+#include <emr/detail/retire_list.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+struct Foo : emr::detail::deletable_object_impl<Foo>
+{
+  Foo(int& deleted) : deleted(deleted) {}
+  ~Foo() { ++deleted; }
+  int& deleted;
+};
+
+TEST(retire_list, new_list_is_empty)
+{
+  emr::detail::retire_list list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(0u, list.size());
+}
+
+TEST(retire_list, delete_objects_deletes_all_pushed_objects)
+{
+  int deleted = 0;
+  emr::detail::retire_list list;
+  for (int i = 0; i < 1000; ++i)
+    list.push(new Foo(deleted));
+  EXPECT_EQ(1000u, list.size());
+
+  list.delete_objects();
+  EXPECT_EQ(1000, deleted);
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(retire_list, consume_visits_every_object_exactly_once)
+{
+  std::vector<Foo*> objects;
+  int deleted = 0;
+  emr::detail::retire_list list;
+  for (int i = 0; i < 200; ++i)
+  {
+    objects.push_back(new Foo(deleted));
+    list.push(objects.back());
+  }
+
+  std::vector<Foo*> visited;
+  list.consume([&visited](emr::detail::deletable_object* p) { visited.push_back(static_cast<Foo*>(p)); });
+  EXPECT_TRUE(list.empty());
+
+  std::sort(objects.begin(), objects.end());
+  std::sort(visited.begin(), visited.end());
+  EXPECT_EQ(objects, visited);
+  for (auto p : objects)
+    p->delete_self();
+}
+
+TEST(retire_list, objects_pushed_during_consume_remain_in_list)
+{
+  int deleted = 0;
+  emr::detail::retire_list list;
+  list.push(new Foo(deleted));
+
+  auto other = new Foo(deleted);
+  list.consume([&list, other](emr::detail::deletable_object* p)
+  {
+    list.push(other);
+    p->delete_self();
+  });
+  EXPECT_EQ(1, deleted);
+  EXPECT_EQ(1u, list.size());
+
+  list.delete_objects();
+  EXPECT_EQ(2, deleted);
+}
+
+TEST(retire_list, consume_with_limit_consumes_at_most_max_nodes)
+{
+  int deleted = 0;
+  emr::detail::retire_list list;
+  for (int i = 0; i < 100; ++i)
+    list.push(new Foo(deleted));
+
+  auto delete_node = [](emr::detail::deletable_object* p) { p->delete_self(); };
+  EXPECT_EQ(70u, list.consume(delete_node, 70));
+  EXPECT_EQ(70, deleted);
+  EXPECT_EQ(30u, list.size());
+
+  EXPECT_EQ(30u, list.consume(delete_node, 70));
+  EXPECT_EQ(100, deleted);
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(retire_list, splice_moves_all_objects_from_other_list)
+{
+  int deleted = 0;
+  emr::detail::retire_list list;
+  emr::detail::retire_list other;
+  for (int i = 0; i < 100; ++i)
+  {
+    list.push(new Foo(deleted));
+    other.push(new Foo(deleted));
+  }
+
+  list.splice(other);
+  EXPECT_TRUE(other.empty());
+  EXPECT_EQ(200u, list.size());
+  list.delete_objects();
+  EXPECT_EQ(200, deleted);
+}
+
+TEST(retire_list, take_nodes_moves_all_objects_to_new_list)
+{
+  int deleted = 0;
+  emr::detail::retire_list list;
+  for (int i = 0; i < 100; ++i)
+    list.push(new Foo(deleted));
+
+  auto other = list.take_nodes();
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(100u, other.size());
+  other.delete_objects();
+  EXPECT_EQ(100, deleted);
+}
+
+}
@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 namespace {
 
 using Reclaimer = emr::stamp_it;
@@ -79,6 +83,177 @@ TEST_F(StampIt, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it)
   EXPECT_NE(nullptr, foo);
 }
 
+TEST_F(StampIt, synchronize_waits_until_threads_inside_a_region_have_left_it)
+{
+  std::atomic<int> step(0);
+  std::thread thread([&step]()
+  {
+    Reclaimer::region_guard region;
+    step.store(1);
+    while (step.load() != 2)
+      std::this_thread::yield();
+  });
+  while (step.load() != 1)
+    std::this_thread::yield();
+
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_FALSE(Reclaimer::try_flush());
+  EXPECT_NE(nullptr, foo);
+
+  step.store(2);
+  Reclaimer::synchronize();
+  EXPECT_EQ(nullptr, foo);
+  thread.join();
+}
+
+TEST_F(StampIt, with_multiple_shards_nodes_are_reclaimed_once_the_threads_of_all_shards_have_left_their_regions)
+{
+  Reclaimer::set_number_of_shards(4);
+
+  std::atomic<int> entered(0);
+  std::atomic<bool> done(false);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i)
+  {
+    threads.emplace_back([&entered, &done]()
+    {
+      Reclaimer::region_guard region;
+      ++entered;
+      while (!done.load())
+        std::this_thread::yield();
+    });
+  }
+  while (entered.load() != 3)
+    std::this_thread::yield();
+
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_NE(nullptr, foo);
+
+  done.store(true);
+  for (auto& thread : threads)
+    thread.join();
+
+  // the shards of the terminated threads are empty now and must not hold back the reclamation
+  EXPECT_TRUE(Reclaimer::try_flush());
+  EXPECT_EQ(nullptr, foo);
+
+  Reclaimer::set_number_of_shards(1);
+}
+
+TEST_F(StampIt, threads_leaving_their_regions_reclaim_the_nodes_from_the_global_retire_list)
+{
+  std::atomic<int> step(0);
+  std::thread thread([&step]()
+  {
+    Reclaimer::region_guard region;
+    step.store(1);
+    while (step.load() != 2)
+      std::this_thread::yield();
+  });
+  while (step.load() != 1)
+    std::this_thread::yield();
+
+  // more nodes than may remain in the local retire-list, so they get added to the global one
+  const int count = 50;
+  std::vector<Foo*> nodes(count);
+  for (auto& node : nodes)
+  {
+    node = new Foo(&node);
+    concurrent_ptr<Foo>::guard_ptr gp(marked_ptr<Foo>(node, 0));
+    gp.reclaim();
+  }
+  for (auto node : nodes)
+    EXPECT_NE(nullptr, node);
+
+  step.store(2);
+  thread.join();
+
+  // each region exit processes a slice of one shard of the global retire-list
+  for (int i = 0; i < 8; ++i)
+    Reclaimer::region_guard region;
+  for (auto node : nodes)
+    EXPECT_EQ(nullptr, node);
+}
+
+TEST_F(StampIt, with_lazy_region_exit_nodes_are_reclaimed_once_the_cached_region_is_left)
+{
+  Reclaimer::enable_lazy_region_exit(3);
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_NE(nullptr, foo);
+
+  { Reclaimer::region_guard region; }
+  { Reclaimer::region_guard region; }
+  EXPECT_NE(nullptr, foo);
+
+  // the limit of cached regions has been reached
+  { Reclaimer::region_guard region; }
+  EXPECT_EQ(nullptr, foo);
+  Reclaimer::disable_lazy_region_exit();
+}
+
+TEST_F(StampIt, try_flush_leaves_a_cached_region)
+{
+  Reclaimer::enable_lazy_region_exit(100);
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_NE(nullptr, foo);
+  EXPECT_TRUE(Reclaimer::try_flush());
+  EXPECT_EQ(nullptr, foo);
+  Reclaimer::disable_lazy_region_exit();
+}
+
+TEST_F(StampIt, with_lazy_region_exit_an_idle_thread_with_a_cached_region_does_not_block_reclamation)
+{
+  Reclaimer::enable_lazy_region_exit(100);
+  std::atomic<int> step(0);
+  std::thread thread([&step]()
+  {
+    // the control block stays in the queue after the region has been left
+    { Reclaimer::region_guard region; }
+    step.store(1);
+    while (step.load() != 2)
+      std::this_thread::yield();
+    // our block has been evicted in the meantime, so this region starts anew
+    { Reclaimer::region_guard region; }
+  });
+  while (step.load() != 1)
+    std::this_thread::yield();
+
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+  }
+  EXPECT_TRUE(Reclaimer::try_flush());
+  EXPECT_EQ(nullptr, foo);
+
+  step.store(2);
+  thread.join();
+  Reclaimer::disable_lazy_region_exit();
+}
+
+TEST_F(StampIt, retired_callback_is_not_called_while_a_region_is_still_active)
+{
+  bool called = false;
+  {
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    Reclaimer::retire([&called]() { called = true; });
+    EXPECT_FALSE(called);
+  }
+  Reclaimer::synchronize();
+  EXPECT_TRUE(called);
+}
+
 TEST_F(StampIt, copy_constructor_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed)
 {
   concurrent_ptr<Foo>::guard_ptr gp(mp);